@@ -0,0 +1,38 @@
+#include "attacks.h"
+
+// Announcements and hit messages
+static const char wallsAnnounce[] PROGMEM = "FIXED WALLS!";
+static const char wallsHit[] PROGMEM = "Touched closing wall! Game Over!";
+static const char hourglassAnnounce[] PROGMEM = "HOURGLASS PATTERN! Find the narrow safe path!";
+static const char hourglassHit[] PROGMEM = "Hit by hourglass attack! Game Over!";
+static const char doubleWallsAnnounce[] PROGMEM = "DOUBLE WALLS! Safe zone in the middle!";
+static const char doubleWallsHit[] PROGMEM = "Hit by double wall! Game Over!";
+static const char tripleAnnounce[] PROGMEM = "TRIPLE DANGER ZONES! Navigate the scattered safe areas!";
+static const char tripleHit[] PROGMEM = "Hit by triple danger zone! Game Over!";
+
+#define ATTACK_TEXT(name) name##Announce, name##Hit
+
+constexpr AttackPattern attackPatterns[] PROGMEM = ATTACK_PATTERN_TABLE(Arena, ATTACK_TEXT);
+
+const uint8_t attackPatternCount = sizeof(attackPatterns) / sizeof(attackPatterns[0]);
+
+// Zones may overlap, so a pattern whose widths add up to less than the ring
+// is certain to leave at least one safe LED
+constexpr int zoneWidths(const AttackPattern &pattern, int z) {
+  return z >= pattern.zoneCount ? 0 : pattern.zones[z].width + zoneWidths(pattern, z + 1);
+}
+
+constexpr bool zonesFit(const AttackPattern &pattern, int z) {
+  return z >= pattern.zoneCount ||
+         (pattern.zones[z].width > 0 && pattern.zones[z].offset > -Arena::size &&
+          pattern.zones[z].offset < Arena::size && zonesFit(pattern, z + 1));
+}
+
+constexpr bool patternsLeaveSafeZone(int i) {
+  return i >= (int)(sizeof(attackPatterns) / sizeof(attackPatterns[0])) ||
+         (zonesFit(attackPatterns[i], 0) && zoneWidths(attackPatterns[i], 0) < Arena::size &&
+          patternsLeaveSafeZone(i + 1));
+}
+
+static_assert(Arena::part(1, 3) <= 127, "zone offsets and widths must fit AttackZone");
+static_assert(patternsLeaveSafeZone(0), "every attack pattern must leave a safe LED on this ring");
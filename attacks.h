@@ -0,0 +1,77 @@
+#ifndef ATTACKS_H
+#define ATTACKS_H
+
+#include "settings.h"
+#include "hazard.h"
+
+// Boss attack patterns
+//
+// Every attack is a row in attackPatterns[] (flash-resident on AVR): a set of
+// danger zones placed relative to the player when the attack starts, the
+// warning and hit colors, and the timings. Adding a pattern is adding a row.
+
+#define MAX_ATTACK_ZONES 3
+
+struct AttackZone {
+  int8_t offset;  // First LED relative to the player
+  uint8_t width;
+};
+
+struct AttackPattern {
+  uint8_t phase;          // 1 or 2
+  uint8_t zoneCount;
+  AttackZone zones[MAX_ATTACK_ZONES];
+  uint32_t warningColor;
+  uint32_t hitColor;
+  uint16_t warningMs;     // At full boss HP, see scaledWarningMs()
+  uint16_t hitMs;
+  uint16_t flashMs;       // Warning blink period at full HP, see scaledFlashMs()
+  const char *announce;   // Flash strings
+  const char *hitMessage;
+};
+
+// The table for ring type R (see ring.h); attacks.cpp instantiates it for
+// Arena, host/fairness for other ring sizes as well. TEXT(name) gives the
+// announcement and hit message of a row.
+#define ATTACK_DARK_RED 0x640000UL
+#define ATTACK_RED 0xFF0000UL
+#define ATTACK_ORANGE 0xFF6400UL
+
+#define ATTACK_PATTERN_TABLE(R, TEXT)                                        \
+  {                                                                          \
+    /* Phase 1: closing walls */                                             \
+    { 1, 2, { { -R::part(1, 4), R::part(1, 8) },                             \
+              { R::part(1, 8), R::part(1, 8) } },                            \
+      ATTACK_DARK_RED, ATTACK_RED, 2000, 2000, 400, TEXT(walls) },           \
+                                                                             \
+    /* Phase 2: hourglass, the player in the neck */                         \
+    { 2, 2, { { -R::part(1, 3), R::part(1, 4) },                             \
+              { R::part(1, 12), R::part(1, 4) } },                           \
+      ATTACK_ORANGE, ATTACK_RED, 2000, 2000, 300, TEXT(hourglass) },         \
+                                                                             \
+    /* Phase 2: double walls */                                              \
+    { 2, 2, { { -R::part(1, 4), R::part(1, 6) },                             \
+              { R::part(1, 6), R::part(1, 6) } },                            \
+      ATTACK_ORANGE, ATTACK_RED, 2000, 2000, 300, TEXT(doubleWalls) },       \
+                                                                             \
+    /* Phase 2: triple danger zones */                                       \
+    { 2, 3, { { -R::part(1, 3), R::part(1, 8) },                             \
+              { 0, R::part(1, 8) },                                          \
+              { R::part(1, 4), R::part(1, 8) } },                            \
+      ATTACK_ORANGE, ATTACK_RED, 2000, 2000, 300, TEXT(triple) },            \
+  }
+
+extern const AttackPattern attackPatterns[] PROGMEM;
+extern const uint8_t attackPatternCount;
+
+// Timings scaled by boss HP in integer math: the warning shrinks from the
+// full duration to half and the blink period grows to double as HP drops.
+constexpr unsigned int scaledWarningMs(uint16_t warningMs, int hp) {
+  return (unsigned long)warningMs * (STRIP2_LEDS + hp) / (2 * STRIP2_LEDS);
+}
+
+constexpr unsigned int scaledFlashMs(uint16_t flashMs, int hp) {
+  return (unsigned long)flashMs * (2 * STRIP2_LEDS - hp) / STRIP2_LEDS;
+}
+
+#endif
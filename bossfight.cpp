@@ -1,91 +1,81 @@
 #include "functions.h"
 
-// Boss fight variables
-int playerPos = 0;
-int playerDir = 1;
-float playerSpeed = 4.0;
-unsigned long lastPlayerMove = 0;
-
-// Attack system
-bool attackActive = false;
-unsigned long attackStartTime = 0;
-unsigned long attackCooldown = 5000;
-const unsigned long attackWarningDuration = 2000;
-const unsigned long attackHitDuration = 2000;
-unsigned long lastAttackTime = 0;
-
-// Phase 1 (closing walls)
-bool wallsClosing = false;
-int leftWallStart = -1;
-int rightWallStart = -1;
-int wallWidth = STRIP1_LEDS / 8;
-bool phase1Flash = false;
-unsigned long lastPhase1Flash = 0;
-
-// Phase 2 (complex patterns)
-bool phase2 = false;
-int attackPattern = 0;
-int dangerZone1Start = -1;
-int dangerZone1Width = 0;
-int dangerZone2Start = -1;
-int dangerZone2Width = 0;
-int dangerZone3Start = -1;
-int dangerZone3Width = 0;
-bool phase2Flash = false;
-unsigned long lastPhase2Flash = 0;
-
-int bossHP = STRIP2_LEDS;
-
-int dropPos = 0;
-bool dropActive = true;
-unsigned long lastDropTime = 0;
-unsigned long dropCooldown = 3000;
-
-unsigned long fightStartTime = 0;
-const unsigned long initialDelay = 3000;
-
-// Main boss fight game loop
-void playBossFight() {
-  unsigned long now = millis();
-  
+TUNABLE BossTuning bossTuning = { 5000, 3500, 3000, 2 * SPEED_ONE, 150, 100 };
+
+// Main boss fight game loop: the simulation advances in fixed ticks of game
+// time up to now, and the result is drawn once afterwards. How often this
+// runs only changes how often the ring is redrawn, not what happens in the
+// fight.
+bool updateBossFight() {
+  unsigned long now = halMillis();
+
+  // Catch up at most SIM_MAX_CATCHUP ticks; beyond that (a long blocking
+  // write) the game pauses for the rest instead of jumping ahead
+  unsigned long behind = now - bossState.simLagMs - bossState.simMs;
+  if (behind > SIM_MAX_CATCHUP * SIM_TICK_MS) {
+    bossState.simLagMs += (behind / SIM_TICK_MS - SIM_MAX_CATCHUP) * SIM_TICK_MS;
+  }
+
+  while (now - bossState.simLagMs - bossState.simMs >= SIM_TICK_MS) {
+    bossState.simMs += SIM_TICK_MS;
+    simulateBossTick();
+    if (effectRunning()) return false; // Hit or win: the flash owns the strips
+  }
+  return true;
+}
+
+// One tick of the fight at game time bossState.simMs
+void simulateBossTick() {
   handlePlayerMovement();
   handleAttackSystem();
   handleDropSystem();
-  drawBossFightDisplay();
   checkCollisions();
-
-  delay(50);
 }
 
 // Handle player movement and direction changes
 void handlePlayerMovement() {
-  unsigned long now = millis();
-  
-  static unsigned long lastButtonPress = 0;
-  if (!digitalRead(BTN_ACTION) && now - lastButtonPress > 200) {
-    playerDir = -playerDir;
-    lastButtonPress = now;
-  }
-  
-  // Increase player speed in phase 2 for better reaction time
-  float currentSpeed = phase2 ? playerSpeed * 1.5 : playerSpeed;
-  
-  if (now - lastPlayerMove > (1000.0 / currentSpeed)) {
-    playerPos = wrapPosition(playerPos + playerDir);
-    lastPlayerMove = now;
+  unsigned long now = bossState.simMs;
+
+  // Presses made up to the end of this tick, by their timestamp
+  ButtonEvent press;
+  while (takePressBefore(BTN_ACTION, (now + bossState.simLagMs) * 1000UL, press)) {
+    bossState.playerDir = -bossState.playerDir;
   }
+
+  // Glide a fraction of an LED per tick; the rules only see the nearest LED
+  long step = playerTravel(bossState.playerStride, bossState.playerCarry);
+  bossState.playerFixed = Arena::stepFixed(bossState.playerFixed, bossState.playerDir > 0 ? step : -step);
+  bossState.playerPos = Arena::led(bossState.playerFixed);
+}
+
+// What rate (8.8 LEDs per second) covers in one tick; divides, so it is
+// worked out when the speed changes rather than every tick
+PlayerStride tickStride(uint16_t rate) {
+  uint32_t travel = (uint32_t)rate * SIM_TICK_MS;
+  PlayerStride stride = { (uint16_t)(travel / 1000), (uint16_t)(travel % 1000) };
+  return stride;
+}
+
+// Distance covered in one tick, in 1/256 LED. The part short of a whole
+// step is carried to the next tick, so the player covers exactly its rate
+// per second however it divides into ticks.
+uint16_t playerTravel(PlayerStride stride, uint16_t &carry) {
+  carry += stride.rest;
+  if (carry < 1000) return stride.step;
+  carry -= 1000;
+  return stride.step + 1;
 }
 
 // Handle attack system logic
 void handleAttackSystem() {
-  unsigned long now = millis();
-  
-  if (now - fightStartTime > initialDelay) {
-    if (!attackActive && now - lastAttackTime > attackCooldown) {
+  unsigned long now = bossState.simMs;
+
+  if (now - bossState.fightStartTime > BOSS_INITIAL_DELAY_MS) {
+    if (!bossState.attackActive && now - bossState.lastAttackTime > bossState.attackCooldown) {
       startAttack();
     }
     
-    if (attackActive) {
+    if (bossState.attackActive) {
       updateAttack();
     }
   }
@@ -93,462 +83,338 @@ void handleAttackSystem() {
 
 // Handle drop spawning and collection
 void handleDropSystem() {
-  unsigned long now = millis();
-  
-  if (!attackActive && !dropActive && now - lastDropTime > dropCooldown) {
-    dropPos = findSafeDropPosition();
-    dropActive = true;
-    Serial.println("New drop appeared!");
+  unsigned long now = bossState.simMs;
+
+  if (!bossState.attackActive && !bossState.dropActive && now - bossState.lastDropTime > bossTuning.dropCooldownMs) {
+    bossState.dropPos = findSafeDropPosition();
+    bossState.dropActive = true;
+    logEvent(EV_DROP_SPAWNED);
   }
 }
 
 // Draw all boss fight elements
 void drawBossFightDisplay() {
-  clearStrips();
+  PROFILE(PROF_BOSS_RENDER);
+  composeBegin();
   
-  if (attackActive) {
-    if (!phase2) {
-      drawPhase1Attack();
-    } else {
-      drawPhase2Attack();
-    }
+  if (bossState.attackActive) {
+    drawAttack();
   }
 
   drawPlayer();
   drawDrops();
   drawBossHP();
 
-  strip1.show();
-  strip2.show();
+  composeFlush();
 }
 
-// Draw player as yellow dot
+// Draw player as yellow dot, between LEDs while it moves
 void drawPlayer() {
-  strip1.setPixelColor(playerPos, strip1.Color(255, 255, 0));
+  composeDot(LAYER_PLAYER, REGION_PLAY, bossState.playerFixed, COLOR_PLAYER);
 }
 
 // Draw boss HP bar
 void drawBossHP() {
-  for (int i = 0; i < STRIP2_LEDS; i++) {
-    if (i < bossHP) {
-      strip2.setPixelColor(i, strip2.Color(255, 0, 0));
-    } else {
-      strip2.setPixelColor(i, strip2.Color(0, 0, 0));
-    }
-  }
+  composeSpan(LAYER_BACKGROUND, REGION_STATUS, 0, bossState.bossHP, COLOR_BOSS_HP);
 }
 
 // Draw collectible drops
 void drawDrops() {
-  if (!attackActive && dropActive) {
-    strip1.setPixelColor(dropPos, strip1.Color(0, 0, 255));
-  }
-}
-
-void drawPhase1Attack() {
-  unsigned long now = millis();
-  unsigned long attackElapsed = now - attackStartTime;
-  
-  // Warning duration decreases as boss HP decreases
-  float hpRatio = (float)bossHP / STRIP2_LEDS;
-  unsigned long dynamicWarningDuration = attackWarningDuration * (0.5 + 0.5 * hpRatio);
-  
-  if (attackElapsed < dynamicWarningDuration) {
-    drawPhase1Warning();
-  } else {
-    drawPhase1Active();
-  }
-}
-
-void drawPhase1Warning() {
-  unsigned long now = millis();
-  
-  // Flash speed increases as boss HP decreases
-  float hpRatio = (float)bossHP / STRIP2_LEDS;
-  int flashSpeed = 400 + (400 * (1.0 - hpRatio)); // 400ms to 800ms based on HP
-  
-  if (now - lastPhase1Flash > flashSpeed) {
-    phase1Flash = !phase1Flash;
-    lastPhase1Flash = now;
-  }
-  
-  if (phase1Flash) {
-    // Show where walls WILL appear (dark red)
-    for (int i = 0; i < wallWidth; i++) {
-      strip1.setPixelColor(wrapPosition(leftWallStart + i), strip1.Color(100, 0, 0)); // Dark red warning
-      strip1.setPixelColor(wrapPosition(rightWallStart + i), strip1.Color(100, 0, 0)); // Dark red warning
-    }
+  if (!bossState.attackActive && bossState.dropActive) {
+    composePixel(LAYER_MARKS, REGION_PLAY, bossState.dropPos, COLOR_DROP);
   }
 }
 
-void drawPhase1Active() {
-  // Attack phase - walls are active (bright red) - FIXED POSITION
-  for (int i = 0; i < wallWidth; i++) {
-    strip1.setPixelColor(wrapPosition(leftWallStart + i), strip1.Color(255, 0, 0)); // Bright red active
-    strip1.setPixelColor(wrapPosition(rightWallStart + i), strip1.Color(255, 0, 0)); // Bright red active
-  }
-}
+// Draw the running attack: blinking warning, then the active zones. The
+// blink follows game time, so it looks the same at any redraw rate.
+void drawAttack() {
+  unsigned long attackElapsed = bossState.simMs - bossState.attackStartTime;
 
-void drawPhase2Attack() {
-  unsigned long now = millis();
-  unsigned long attackElapsed = now - attackStartTime;
-  
-  // Warning duration decreases as boss HP decreases
-  float hpRatio = (float)bossHP / STRIP2_LEDS;
-  unsigned long dynamicWarningDuration = attackWarningDuration * (0.5 + 0.5 * hpRatio);
-  
-  if (attackElapsed < dynamicWarningDuration) {
-    drawPhase2Warning();
+  if (attackElapsed < bossState.attackWarningMs) {
+    if (bossState.attackBlinkOn) drawAttackZones(bossState.attack.warningColor);
   } else {
-    drawPhase2Active();
-  }
-}
-
-void drawPhase2Warning() {
-  unsigned long now = millis();
-  
-  // Flash speed increases as boss HP decreases
-  float hpRatio = (float)bossHP / STRIP2_LEDS;
-  int flashSpeed = 300 + (300 * (1.0 - hpRatio)); // 300ms to 600ms based on HP
-  
-  if (now - lastPhase2Flash > flashSpeed) {
-    phase2Flash = !phase2Flash;
-    lastPhase2Flash = now;
-  }
-  
-  if (phase2Flash) {
-    switch (attackPattern) {
-      case 0: // HOURGLASS pattern
-        for (int i = 0; i < dangerZone1Width; i++) {
-          strip1.setPixelColor(wrapPosition(dangerZone1Start + i), strip1.Color(255, 100, 0)); // Orange danger
-        }
-        for (int i = 0; i < dangerZone2Width; i++) {
-          strip1.setPixelColor(wrapPosition(dangerZone2Start + i), strip1.Color(255, 100, 0)); // Orange danger
-        }
-        break;
-        
-      case 1: // DOUBLE WALLS pattern
-        for (int i = 0; i < dangerZone1Width; i++) {
-          strip1.setPixelColor(wrapPosition(dangerZone1Start + i), strip1.Color(255, 100, 0)); // Orange danger
-        }
-        for (int i = 0; i < dangerZone2Width; i++) {
-          strip1.setPixelColor(wrapPosition(dangerZone2Start + i), strip1.Color(255, 100, 0)); // Orange danger
-        }
-        break;
-        
-      case 2: // TRIPLE DANGER ZONES pattern
-        for (int i = 0; i < dangerZone1Width; i++) {
-          strip1.setPixelColor(wrapPosition(dangerZone1Start + i), strip1.Color(255, 100, 0)); // Orange danger
-        }
-        for (int i = 0; i < dangerZone2Width; i++) {
-          strip1.setPixelColor(wrapPosition(dangerZone2Start + i), strip1.Color(255, 100, 0)); // Orange danger
-        }
-        for (int i = 0; i < dangerZone3Width; i++) {
-          strip1.setPixelColor(wrapPosition(dangerZone3Start + i), strip1.Color(255, 100, 0)); // Orange danger
-        }
-        break;
-    }
+    drawAttackZones(bossState.attack.hitColor);
   }
 }
 
-void drawPhase2Active() {
-  // Attack phase - danger zones active (red)
-  switch (attackPattern) {
-    case 0: // HOURGLASS pattern
-      for (int i = 0; i < dangerZone1Width; i++) {
-        strip1.setPixelColor(wrapPosition(dangerZone1Start + i), strip1.Color(255, 0, 0)); // Red active
-      }
-      for (int i = 0; i < dangerZone2Width; i++) {
-        strip1.setPixelColor(wrapPosition(dangerZone2Start + i), strip1.Color(255, 0, 0)); // Red active
-      }
-      break;
-      
-    case 1: // DOUBLE WALLS pattern
-      for (int i = 0; i < dangerZone1Width; i++) {
-        strip1.setPixelColor(wrapPosition(dangerZone1Start + i), strip1.Color(255, 0, 0)); // Red active
-      }
-      for (int i = 0; i < dangerZone2Width; i++) {
-        strip1.setPixelColor(wrapPosition(dangerZone2Start + i), strip1.Color(255, 0, 0)); // Red active
-      }
-      break;
-      
-    case 2: // TRIPLE DANGER ZONES pattern
-      for (int i = 0; i < dangerZone1Width; i++) {
-        strip1.setPixelColor(wrapPosition(dangerZone1Start + i), strip1.Color(255, 0, 0)); // Red active
-      }
-      for (int i = 0; i < dangerZone2Width; i++) {
-        strip1.setPixelColor(wrapPosition(dangerZone2Start + i), strip1.Color(255, 0, 0)); // Red active
-      }
-      for (int i = 0; i < dangerZone3Width; i++) {
-        strip1.setPixelColor(wrapPosition(dangerZone3Start + i), strip1.Color(255, 0, 0)); // Red active
-      }
-      break;
-  }
+// Paint every LED covered by the running attack; the player stays visible
+// through it
+void drawAttackZones(uint32_t color) {
+  composeMask(LAYER_HAZARDS, REGION_PLAY, bossState.hazard.bits, color, ALPHA_HAZARD);
 }
 
 // Check all collision types
 void checkCollisions() {
-  unsigned long now = millis();
-  
-  if (attackActive) {
-    unsigned long attackElapsed = now - attackStartTime;
-    
-    // Use dynamic warning duration based on boss HP
-    float hpRatio = (float)bossHP / STRIP2_LEDS;
-    unsigned long dynamicWarningDuration = attackWarningDuration * (0.5 + 0.5 * hpRatio);
-    
-    if (attackElapsed >= dynamicWarningDuration) { 
-      if (!phase2) {
-        checkPhase1Collision();
-      } else {
-        checkPhase2Collision();
-      }
-    }
+  unsigned long now = bossState.simMs;
+
+  if (bossState.attackActive && now - bossState.attackStartTime >= bossState.attackWarningMs) {
+    checkAttackCollision();
   }
 
   // Drop collection
-  if (!attackActive && dropActive && playerPos == dropPos) {
-    bossHP--;
-    dropActive = false;
-    lastDropTime = now;
-    Serial.print("Boss hit! HP: ");
-    Serial.println(bossHP);
-
-    if (bossHP <= STRIP2_LEDS / 2 && !phase2) {
-      phase2 = true;
-      attackCooldown = 3500; 
-      attackActive = false;
-      Serial.println("Phase 2 activated! Complex attack patterns incoming!");
+  if (!bossState.attackActive && bossState.dropActive && bossState.playerPos == bossState.dropPos) {
+    bossState.bossHP--;
+    bossState.dropActive = false;
+    bossState.lastDropTime = now;
+    logEvent(EV_BOSS_HIT, bossState.bossHP);
+    persistTouch();
+
+    if (bossState.bossHP <= STRIP2_LEDS / 2 && !bossState.phase2) {
+      bossState.phase2 = true;
+      bossState.attackCooldown = bossTuning.phase2CooldownMs;
+      bossState.attackActive = false;
+      updatePlayerSpeed();
+      logEvent(EV_PHASE2);
     }
 
-    if (bossHP <= 0) {
-      Serial.println("Boss defeated! You win!");
-      successFlash();
-      resetBossFight();
+    if (bossState.bossHP <= 0) {
+      logEvent(EV_BOSS_DEFEATED);
+      unsigned long fightMs = now - bossState.fightStartTime;
+      persisted.bossWins++;
+      if (persisted.bossBestMs == 0 || fightMs < persisted.bossBestMs) persisted.bossBestMs = fightMs;
+      successFlash(resetBossFight);
       return;
     }
   }
 }
 
-// Check collision with phase 1 closing walls
-void checkPhase1Collision() {
-  for (int i = 0; i < wallWidth; i++) {
-    if (playerPos == wrapPosition(leftWallStart + i) || 
-        playerPos == wrapPosition(rightWallStart + i)) {
-      Serial.println("Touched closing wall! Game Over!");
-      failFlash();
-      resetBossFight();
-      return;
-    }
+// Check collision with the zones of the running attack
+void checkAttackCollision() {
+  if (hazardTest(bossState.hazard, bossState.playerPos)) {
+    logEvent(EV_ATTACK_HIT, bossState.attackPattern);
+    failFlash(resetBossFight);
+  }
+}
+
+// The warning of an attack at hp, scaled by bossTuning.warningPct. The
+// attack ends at its full-HP warning plus hitMs, so a warning longer than
+// that would eat into the hit window: warningPct only shortens it.
+unsigned int tunedWarningMs(uint16_t warningMs, int hp) {
+  uint8_t pct = bossTuning.warningPct < 100 ? bossTuning.warningPct : 100;
+  return scaledWarningMs(warningMs, hp) * (unsigned long)pct / 100;
+}
+
+// Bring the warning blink up to the current tick: it toggles every
+// attackFlashMs of the warning, lit first, counted by adding rather than
+// dividing the time into the attack
+static void advanceAttackBlink() {
+  unsigned long attackElapsed = bossState.simMs - bossState.attackStartTime;
+  while (attackElapsed < bossState.attackWarningMs && attackElapsed >= bossState.attackBlinkMs) {
+    bossState.attackBlinkOn = !bossState.attackBlinkOn;
+    bossState.attackBlinkMs += bossState.attackFlashMs;
   }
 }
 
-// Check collision with phase 2 danger zones
-void checkPhase2Collision() {
-  switch (attackPattern) {
-    case 0: // Hourglass pattern
-      for (int i = 0; i < dangerZone1Width; i++) {
-        if (playerPos == wrapPosition(dangerZone1Start + i)) {
-          Serial.println("Hit by hourglass attack! Game Over!");
-          failFlash();
-          resetBossFight();
-          return;
-        }
-      }
-      for (int i = 0; i < dangerZone2Width; i++) {
-        if (playerPos == wrapPosition(dangerZone2Start + i)) {
-          Serial.println("Hit by hourglass attack! Game Over!");
-          failFlash();
-          resetBossFight();
-          return;
-        }
-      }
-      break;
-      
-    case 1: // Double walls pattern
-      for (int i = 0; i < dangerZone1Width; i++) {
-        if (playerPos == wrapPosition(dangerZone1Start + i)) {
-          Serial.println("Hit by double wall! Game Over!");
-          failFlash();
-          resetBossFight();
-          return;
-        }
-      }
-      for (int i = 0; i < dangerZone2Width; i++) {
-        if (playerPos == wrapPosition(dangerZone2Start + i)) {
-          Serial.println("Hit by double wall! Game Over!");
-          failFlash();
-          resetBossFight();
-          return;
-        }
-      }
-      break;
-      
-    case 2: // Triple danger zones pattern
-      for (int i = 0; i < dangerZone1Width; i++) {
-        if (playerPos == wrapPosition(dangerZone1Start + i)) {
-          Serial.println("Hit by triple danger zone! Game Over!");
-          failFlash();
-          resetBossFight();
-          return;
-        }
-      }
-      for (int i = 0; i < dangerZone2Width; i++) {
-        if (playerPos == wrapPosition(dangerZone2Start + i)) {
-          Serial.println("Hit by triple danger zone! Game Over!");
-          failFlash();
-          resetBossFight();
-          return;
-        }
-      }
-      for (int i = 0; i < dangerZone3Width; i++) {
-        if (playerPos == wrapPosition(dangerZone3Start + i)) {
-          Serial.println("Hit by triple danger zone! Game Over!");
-          failFlash();
-          resetBossFight();
-          return;
-        }
-      }
-      break;
+// Load attack pattern bossState.attackPattern, placed around
+// bossState.attackAnchor, and scale its timings to the boss HP
+static void loadAttack() {
+  memcpy_P(&bossState.attack, &attackPatterns[bossState.attackPattern], sizeof(AttackPattern));
+
+  // Boss HP cannot change during an attack, so scale the timings once here
+  bossState.attackWarningMs = tunedWarningMs(bossState.attack.warningMs, bossState.bossHP);
+  bossState.attackFlashMs = scaledFlashMs(bossState.attack.flashMs, bossState.bossHP);
+  bossState.attackBlinkOn = false;
+  bossState.attackBlinkMs = 0;
+  advanceAttackBlink();
+
+  hazardClear(bossState.hazard);
+  for (int z = 0; z < bossState.attack.zoneCount; z++) {
+    int start = wrapPosition(bossState.attackAnchor + bossState.attack.zones[z].offset);
+    hazardAddZone(bossState.hazard, start, bossState.attack.zones[z].width);
   }
 }
 
 // Start a new attack based on current phase
 void startAttack() {
-  attackActive = true;
-  attackStartTime = millis();
-  
-  if (!phase2) {
+  bossState.attackActive = true;
+  bossState.attackStartTime = bossState.simMs;
+  bossState.attackAnchor = bossState.playerPos;
+
+  if (!bossState.phase2) {
     // Phase 1: Closing walls
-    leftWallStart = wrapPosition(playerPos - STRIP1_LEDS / 4);
-    rightWallStart = wrapPosition(playerPos + STRIP1_LEDS / 8);
-    
-    Serial.print("FIXED WALLS! Left: ");
-    Serial.print(leftWallStart);
-    Serial.print(" Right: ");
-    Serial.println(rightWallStart);
-    
-    phase1Flash = true;
-    lastPhase1Flash = millis();
+    bossState.attackPattern = 0;
   } else {
     // Phase 2: Complex patterns
-    attackPattern = random(3); 
-    
-    switch (attackPattern) {
-      case 0: // Hourglass pattern
-        dangerZone1Start = wrapPosition(playerPos - STRIP1_LEDS / 6);
-        dangerZone1Width = STRIP1_LEDS / 3;
-        dangerZone2Start = wrapPosition(playerPos + STRIP1_LEDS / 3);
-        dangerZone2Width = STRIP1_LEDS / 3;
-        Serial.println("HOURGLASS PATTERN! Find the narrow safe path!");
-        break;
-        
-      case 1: // Double walls pattern
-        dangerZone1Start = wrapPosition(playerPos - STRIP1_LEDS / 4);
-        dangerZone1Width = STRIP1_LEDS / 6;
-        dangerZone2Start = wrapPosition(playerPos + STRIP1_LEDS / 6);
-        dangerZone2Width = STRIP1_LEDS / 6;
-        Serial.println("DOUBLE WALLS! Safe zone in the middle!");
-        break;
-        
-      case 2: // Triple danger zones pattern
-        dangerZone1Start = wrapPosition(playerPos - STRIP1_LEDS / 3);
-        dangerZone1Width = STRIP1_LEDS / 8;
-        dangerZone2Start = wrapPosition(playerPos);
-        dangerZone2Width = STRIP1_LEDS / 8;
-        dangerZone3Start = wrapPosition(playerPos + STRIP1_LEDS / 4);
-        dangerZone3Width = STRIP1_LEDS / 8;
-        Serial.println("TRIPLE DANGER ZONES! Navigate the scattered safe areas!");
-        break;
-    }
-    
-    phase2Flash = true;
-    lastPhase2Flash = millis();
+    bossState.attackPattern = 1 + rngNext(RNG_ATTACKS, attackPatternCount - 1);
+  }
+  loadAttack();
+
+  // Log the pattern and where its zones landed
+  int16_t attackLog[1 + MAX_ATTACK_ZONES];
+  attackLog[0] = bossState.attackPattern;
+  for (int z = 0; z < bossState.attack.zoneCount; z++) {
+    attackLog[1 + z] = wrapPosition(bossState.attackAnchor + bossState.attack.zones[z].offset);
   }
+  logEventValues(EV_ATTACK_START, attackLog, 1 + bossState.attack.zoneCount);
 }
 
 // Update attack state and end when duration expires
 void updateAttack() {
-  unsigned long now = millis();
-  unsigned long attackElapsed = now - attackStartTime;
-  
-  if (attackElapsed > attackWarningDuration + attackHitDuration) {
-    attackActive = false;
-    lastAttackTime = now;
-    Serial.println("Attack ended!");
+  unsigned long now = bossState.simMs;
+  unsigned long attackElapsed = now - bossState.attackStartTime;
+  advanceAttackBlink();
+
+  if (attackElapsed > (unsigned long)bossState.attack.warningMs + bossState.attack.hitMs) {
+    bossState.attackActive = false;
+    bossState.lastAttackTime = now;
+    logEvent(EV_ATTACK_END);
   }
 }
 
 // Reset boss fight to initial state
+// Entering the mode picks up a fight suspended by exitBossFight(), even
+// across a reboot (see persist.h)
+void enterBossFight() {
+  resetBossFight();
+  resumeBossFight(persisted.boss);
+}
+
+void exitBossFight() {
+  suspendBossFight(persisted.boss);
+}
+
 void resetBossFight() {
-  bossHP = STRIP2_LEDS;
-  phase2 = false;
-  playerPos = 0;
-  playerDir = 1;
-  playerSpeed = 2.0;
-  attackActive = false;
-  leftWallStart = -1;
-  rightWallStart = -1;
-  dangerZone1Start = -1;
-  dangerZone2Start = -1;
-  dangerZone3Start = -1;
-  dropPos = findSafeDropPosition();
-  dropActive = true;
-  lastDropTime = millis();
-  fightStartTime = millis();
-  lastPlayerMove = millis();
-  lastAttackTime = millis();
-  attackCooldown = 5000;
-  dropCooldown = 3000;
-  Serial.println("Boss fight reset!");
+  bossState = BossState();
+  bossState.simMs = halMillis() / SIM_TICK_MS * SIM_TICK_MS; // Ticks on a fixed grid
+  bossState.simLagMs = 0;
+  bossState.bossHP = STRIP2_LEDS;
+  bossState.phase2 = false;
+  bossState.playerPos = 0;
+  bossState.playerFixed = 0;
+  bossState.playerCarry = 0;
+  bossState.playerDir = 1;
+  bossState.playerSpeed = bossTuning.playerSpeed;
+  bossState.attackActive = false;
+  bossState.dropPos = findSafeDropPosition();
+  bossState.dropActive = true;
+  bossState.lastDropTime = bossState.simMs;
+  bossState.fightStartTime = bossState.simMs;
+  bossState.lastAttackTime = bossState.simMs;
+  bossState.attackCooldown = bossTuning.attackCooldownMs;
+  updatePlayerSpeed();
+  flushPresses(BTN_ACTION);
+  logEvent(EV_BOSS_RESET);
+  persistTouch(); // A lost or won fight is not resumed
+}
+
+static uint16_t clampMs(unsigned long ms) {
+  return ms > 0xFFFF ? 0xFFFF : ms;
+}
+
+// Snapshot the fight so resumeBossFight() can pick it up later, possibly
+// after a reboot. A fight that just ended is not worth resuming.
+void suspendBossFight(BossSnapshot &s) {
+  memset(&s, 0, sizeof(s));
+  if (effectRunning()) return;
+
+  unsigned long now = bossState.simMs;
+  s.valid = true;
+  s.fightMs = now - bossState.fightStartTime;
+  long offset = bossState.playerFixed - (long)bossState.playerPos * POS_ONE;
+  s.playerOffset = Arena::wrapFixed(offset + POS_ONE / 2) - POS_ONE / 2; // Across the wrap too
+  s.sinceAttack = clampMs(now - (bossState.attackActive ? bossState.attackStartTime : bossState.lastAttackTime));
+  s.sinceDrop = clampMs(now - bossState.lastDropTime);
+  s.playerPos = bossState.playerPos;
+  s.dropPos = bossState.dropPos;
+  s.attackAnchor = bossState.attackAnchor;
+  s.bossHP = bossState.bossHP;
+  s.playerDir = bossState.playerDir;
+  s.attackPattern = bossState.attackPattern;
+  s.phase2 = bossState.phase2;
+  s.dropActive = bossState.dropActive;
+  s.attackActive = bossState.attackActive;
+}
+
+// Continue a suspended fight from a freshly reset one, at the same point of
+// every timer; false (and the fresh fight) if there is nothing sane to resume
+bool resumeBossFight(const BossSnapshot &s) {
+  if (!s.valid || s.bossHP < 1 || s.bossHP > STRIP2_LEDS || (s.playerDir != 1 && s.playerDir != -1) ||
+      s.playerPos < 0 || s.playerPos >= Arena::size || s.playerOffset < -POS_ONE / 2 ||
+      s.playerOffset >= POS_ONE / 2 || s.dropPos < 0 || s.dropPos >= Arena::size ||
+      s.attackAnchor < 0 || s.attackAnchor >= Arena::size || s.attackPattern >= attackPatternCount) {
+    return false;
+  }
+
+  unsigned long now = bossState.simMs;
+  bossState.bossHP = s.bossHP;
+  bossState.phase2 = s.phase2;
+  bossState.playerPos = s.playerPos;
+  bossState.playerFixed = Arena::wrapFixed((long)s.playerPos * POS_ONE + s.playerOffset);
+  bossState.playerDir = s.playerDir;
+  bossState.dropPos = s.dropPos;
+  bossState.dropActive = s.dropActive;
+  bossState.attackCooldown = s.phase2 ? bossTuning.phase2CooldownMs : bossTuning.attackCooldownMs;
+  updatePlayerSpeed();
+
+  bossState.fightStartTime = now - s.fightMs;
+  bossState.lastDropTime = now - s.sinceDrop;
+  bossState.lastAttackTime = now - s.sinceAttack;
+  bossState.attackActive = s.attackActive;
+  if (s.attackActive) {
+    bossState.attackPattern = s.attackPattern;
+    bossState.attackAnchor = s.attackAnchor;
+    bossState.attackStartTime = now - s.sinceAttack;
+    loadAttack();
+  }
+  logEvent(EV_BOSS_RESUMED, bossState.bossHP);
+  return true;
+}
+
+// Recompute the movement rate after a speed or phase change
+void updatePlayerSpeed() {
+  // Increase player speed in phase 2 for better reaction time
+  unsigned long speed = bossState.playerSpeed;
+  if (bossState.phase2) speed = speed * bossTuning.phase2SpeedPct / 100;
+  bossState.playerRate = speed > 0xFFFF ? 0xFFFF : speed;
+  bossState.playerStride = tickStride(bossState.playerRate);
 }
 
-// Find a safe position for drops (not on player)
+// Find a safe position for drops (not on player or a live hazard)
 int findSafeDropPosition() {
-  int newPos;
-  do {
-    newPos = random(STRIP1_LEDS);
-  } while (newPos == playerPos);
-  
-  return newPos;
+  HazardMap blocked;
+  if (bossState.attackActive) {
+    blocked = bossState.hazard;
+  } else {
+    hazardClear(blocked);
+  }
+  hazardSet(blocked, bossState.playerPos);
+  hazardInvert(blocked);
+
+  int freeCount = hazardCount(blocked);
+  if (freeCount == 0) return bossState.playerPos;
+  return hazardNth(blocked, rngNext(RNG_DROPS, freeCount));
 }
 
-// Toroidal position wrapping for circular LED strip
-int wrapPosition(int pos) {
-  if (pos < 0) {
-    return STRIP1_LEDS + pos;
-  } else if (pos >= STRIP1_LEDS) {
-    return pos - STRIP1_LEDS;
+// Three on/off flashes of the play ring in flashColor, 100 ms each
+static uint32_t flashColor = 0;
+
+static bool flashEffect(Pt *pt) {
+  static int i;
+  PT_BEGIN(pt);
+  for (i = 0; i < 3; i++) {
+    canvasFill(REGION_PLAY, flashColor);
+    canvasFlush();
+    PT_WAIT_MS(pt, 100);
+    canvasFill(REGION_PLAY, 0);
+    canvasFlush();
+    PT_WAIT_MS(pt, 100);
   }
-  return pos;
+  PT_END(pt);
 }
 
 // Visual feedback for success
-void successFlash() {
-  for (int i = 0; i < 3; i++) {
-    strip1.fill(strip1.Color(0, 255, 0));
-    strip1.show();
-    delay(100);
-    strip1.clear();
-    strip1.show();
-    delay(100);
-  }
+void successFlash(TaskFn then) {
+  flashColor = Adafruit_NeoPixel::Color(0, 255, 0);
+  playEffect(flashEffect, then);
 }
 
 // Visual feedback for failure
-void failFlash() {
-  for (int i = 0; i < 3; i++) {
-    strip1.fill(strip1.Color(255, 0, 0));
-    strip1.show();
-    delay(100);
-    strip1.clear();
-    strip1.show();
-    delay(100);
-  }
+void failFlash(TaskFn then) {
+  flashColor = Adafruit_NeoPixel::Color(255, 0, 0);
+  playEffect(flashEffect, then);
 }
 
-// Clear both LED strips
+// Clear every LED strip
 void clearStrips() {
-  strip1.clear();
-  strip2.clear();
+  canvasClear();
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "canvas.h"
+
+// Physical strips in chain order
+static FrameBuffer *const strips[] = { &frame1, &frame2 };
+#define CANVAS_STRIPS (sizeof(strips) / sizeof(strips[0]))
+static_assert(CANVAS_STRIPS <= 8, "dirty strips are tracked in one byte");
+
+// Per-region transform: logical position p shows at (reversed ? -p : p) +
+// rotation, taken around the region
+struct RegionTransform {
+  uint16_t size;
+  uint16_t rotation;
+  bool reversed;
+};
+
+// Logical range [first, first + count) of a region, after its transform,
+// lands on pixel, pixel + step, ... of a strip
+struct Segment {
+  uint8_t region;
+  uint8_t strip;
+  uint16_t first;
+  uint16_t count;
+  uint16_t pixel;
+  int8_t step; // 1, or -1 for a strip wired backwards
+};
+
+// Layout: a 24-LED play ring on the first strip, the HP / difficulty bar on
+// the second
+static const RegionTransform regions[REGION_COUNT] = {
+  { REGION_PLAY_SIZE, 0, false },
+  { REGION_STATUS_SIZE, 0, false },
+};
+
+static const Segment segments[] = {
+  { REGION_PLAY, 0, 0, REGION_PLAY_SIZE, 0, 1 },
+  { REGION_STATUS, 1, 0, REGION_STATUS_SIZE, 0, 1 },
+};
+
+#define CANVAS_SEGMENTS (sizeof(segments) / sizeof(segments[0]))
+
+static uint8_t dirtyStrips = 0xFF;
+
+uint16_t canvasSize(Region region) {
+  return regions[region].size;
+}
+
+void canvasSet(Region region, int pos, uint32_t color) {
+  const RegionTransform &transform = regions[region];
+  if (pos < 0 || pos >= transform.size) return;
+  if (transform.reversed && pos) pos = transform.size - pos;
+  pos += transform.rotation;
+  if (pos >= transform.size) pos -= transform.size;
+
+  for (uint8_t s = 0; s < CANVAS_SEGMENTS; s++) {
+    const Segment &seg = segments[s];
+    if (seg.region != region || pos < seg.first || pos >= seg.first + seg.count) continue;
+    strips[seg.strip]->strip->setPixelColor(seg.pixel + (pos - seg.first) * seg.step, color);
+    dirtyStrips |= 1 << seg.strip;
+  }
+}
+
+void canvasFill(Region region, uint32_t color) {
+  canvasFillRange(region, 0, regions[region].size, color);
+}
+
+// Fill the transformed positions [first, first + count) of a region, which
+// wrap past its end, on every segment showing them
+static void fillTransformed(Region region, uint16_t first, uint16_t count, uint32_t color) {
+  uint16_t size = regions[region].size;
+  for (uint8_t s = 0; s < CANVAS_SEGMENTS; s++) {
+    const Segment &seg = segments[s];
+    if (seg.region != region) continue;
+    uint8_t *grb = strips[seg.strip]->strip->getPixels();
+    dirtyStrips |= 1 << seg.strip;
+
+    // A segment wired forward over the whole region is the ring itself
+    if (seg.first == 0 && seg.count == size && seg.step > 0) {
+      pixelFillWrap(grb + 3 * seg.pixel, size, first, count, color);
+      continue;
+    }
+    // Otherwise the range is at most two pieces to clip to the segment
+    uint16_t head = count < size - first ? count : size - first;
+    uint16_t pieces[2][2] = { { first, (uint16_t)(first + head) }, { 0, (uint16_t)(count - head) } };
+    for (uint8_t p = 0; p < 2; p++) {
+      uint16_t a = pieces[p][0] > seg.first ? pieces[p][0] : seg.first;
+      uint16_t b = pieces[p][1] < seg.first + seg.count ? pieces[p][1] : seg.first + seg.count;
+      if (a >= b) continue;
+      uint16_t pixel = seg.step > 0 ? seg.pixel + (a - seg.first) : seg.pixel - (b - 1 - seg.first);
+      pixelFill(grb + 3 * pixel, b - a, color);
+    }
+  }
+}
+
+// Fill logical positions [first, first + count) of a region with the packed
+// pixel kernels. The transform maps the range to one range of the ring
+// (reversed, it runs the other way but still covers a contiguous stretch).
+void canvasFillRange(Region region, uint16_t first, uint16_t count, uint32_t color) {
+  const RegionTransform &transform = regions[region];
+  if (first >= transform.size) return;
+  if (count > transform.size - first) count = transform.size - first;
+  if (!count) return;
+  if (transform.reversed) first = (transform.size - (first + count - 1)) % transform.size;
+  first = (first + transform.rotation) % transform.size;
+  fillTransformed(region, first, count, color);
+}
+
+void canvasClear() {
+  for (uint8_t i = 0; i < CANVAS_STRIPS; i++) strips[i]->strip->clear();
+  dirtyStrips = 0xFF;
+}
+
+// Present the strips written since the last flush
+void canvasFlush() {
+  for (uint8_t i = 0; i < CANVAS_STRIPS; i++) {
+    if (dirtyStrips & (1 << i)) presentFrame(*strips[i]);
+  }
+  dirtyStrips = 0;
+}
+
+void canvasInvalidate() {
+  for (uint8_t i = 0; i < CANVAS_STRIPS; i++) invalidateFrame(*strips[i]);
+  dirtyStrips = 0xFF;
+}
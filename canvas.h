@@ -0,0 +1,33 @@
+#ifndef CANVAS_H
+#define CANVAS_H
+
+#include "framebuffer.h"
+#include "ring.h"
+#include "pixels.h"
+
+// Virtual canvas
+//
+// Modes draw into logical regions (the play ring, the status bar, ...) and
+// never name a physical strip. The layout in canvas.cpp maps each region
+// onto one or more segments of the chained strips, after an optional
+// rotation and reversal of the region's own coordinates, so a new
+// installation is a new layout table rather than new draw code. A region
+// can span strips or be mirrored onto several of them.
+//
+// Writes mark their strips dirty and canvasFlush() presents only those.
+
+enum Region { REGION_PLAY, REGION_STATUS, REGION_COUNT };
+
+// Logical size of every region, independent of how it is wired
+#define REGION_PLAY_SIZE Arena::size
+#define REGION_STATUS_SIZE Gauge::size
+
+uint16_t canvasSize(Region region);
+void canvasSet(Region region, int pos, uint32_t color); // Out-of-range positions are ignored
+void canvasFill(Region region, uint32_t color);
+void canvasClear();
+void canvasFillRange(Region region, uint16_t first, uint16_t count, uint32_t color); // Clipped to the region
+void canvasFlush();
+void canvasInvalidate(); // Push every strip on the next flush
+
+#endif
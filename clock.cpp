@@ -1,51 +1,63 @@
 #include "functions.h"
 
-// Clock mode variables
-unsigned long lastClockUpdate = 0;
+static void splitTime(uint32_t now, int &hours, int &minutes, int &seconds) {
+  seconds = now % 60;
+  minutes = (now / 60) % 60;
+  hours   = (now / 3600) % 12;
+}
 
-// Main clock display function
-void showClock() {
-  unsigned long now = millis() / 1000.0 * CLOCK_SPEED;
-  int seconds = now % 60;
-  int minutes = (now / 60) % 60;
-  int hours   = (now / 3600) % 12;
+// Advance the clock; the hands only move when the second changes
+bool updateClock() {
+  timeUpdate();
+  uint32_t now = timeNow();
+  if (now == clockState.shownSecond) return false;
+  clockState.shownSecond = now;
+
+  // Log time every second
+  if (halMillis() - clockState.lastLog > 1000) {
+    int hours, minutes, seconds;
+    splitTime(now, hours, minutes, seconds);
+    logClockTime(hours, minutes, seconds);
+    clockState.lastLog = halMillis();
+  }
+  return true;
+}
 
+// Draw the second updateClock() moved to
+void drawClock() {
+  int hours, minutes, seconds;
+  splitTime(clockState.shownSecond, hours, minutes, seconds);
   updateClockDisplay(hours, minutes, seconds);
-  
-  // Print time every second
-  if (millis() - lastClockUpdate > 1000) {
-    printClockTime(hours, minutes, seconds);
-    lastClockUpdate = millis();
-  }
+}
 
-  delay(50);
+// Enter clock mode: the hands are drawn on the next frame
+void resetClock() {
+  clockState = ClockState();
+  clockState.shownSecond = 0xFFFFFFFFUL;
 }
 
 // Update LED display with clock hands
 void updateClockDisplay(int hours, int minutes, int seconds) {
+  PROFILE(PROF_CLOCK_RENDER);
   int secPos  = (seconds * STRIP1_LEDS) / 60; 
   int minPos  = (minutes * STRIP1_LEDS) / 60;
   int hourPos = (hours * STRIP1_LEDS) / 12;
 
-  clearStrips();
+  composeBegin();
+
+  // Red = hours, Green = minutes, Blue = seconds; hands on the same LED add
+  // up (yellow, magenta, cyan, white)
+  composePixel(LAYER_HANDS, REGION_PLAY, hourPos, COLOR_HOUR_HAND);
+  composePixel(LAYER_HANDS, REGION_PLAY, minPos, COLOR_MINUTE_HAND);
+  composePixel(LAYER_HANDS, REGION_PLAY, secPos, COLOR_SECOND_HAND);
 
-  // Red = hours, Green = minutes, Blue = seconds
-  strip1.setPixelColor(hourPos, strip1.Color(255, 0, 0));
-  strip1.setPixelColor(minPos, strip1.Color(0, 255, 0));
-  strip1.setPixelColor(secPos, strip1.Color(0, 0, 255));
-  strip1.show();
+  // Status bar shows white background
+  composeSpan(LAYER_BACKGROUND, REGION_STATUS, 0, REGION_STATUS_SIZE, COLOR_CLOCK_FACE);
 
-  // Second strip shows white background
-  strip2.fill(strip2.Color(255, 255, 255));
-  strip2.show();
+  composeFlush(); // Only pushes when a hand moved
 }
 
-// Print current time to serial
-void printClockTime(int hours, int minutes, int seconds) {
-  Serial.print("Clock - H:");
-  Serial.print(hours);
-  Serial.print(" M:");
-  Serial.print(minutes);
-  Serial.print(" S:");
-  Serial.println(seconds);
+// Log current time
+void logClockTime(int hours, int minutes, int seconds) {
+  logEvent(EV_CLOCK_TIME, hours, minutes, seconds);
 }
@@ -0,0 +1,148 @@
+#include "compositor.h"
+
+#define COMPOSITOR_LAYER_BLEND(name, blend) blend,
+static const uint8_t layerBlend[LAYER_COUNT] = { COMPOSITOR_LAYERS(COMPOSITOR_LAYER_BLEND) };
+#undef COMPOSITOR_LAYER_BLEND
+
+// A span [first, first + count) of a region, or the set bits of mask over it
+struct ComposeItem {
+  uint8_t layer;
+  uint8_t region;
+  uint8_t alpha;
+  uint16_t first;
+  uint16_t count;
+  const uint32_t *mask;
+  uint32_t color;
+};
+
+// Kept sorted by layer, in drawing order within a layer
+static ComposeItem items[COMPOSE_MAX_ITEMS];
+static uint8_t itemCount = 0;
+
+void composeBegin() {
+  itemCount = 0;
+}
+
+static void addItem(const ComposeItem &item) {
+  if (itemCount == COMPOSE_MAX_ITEMS) return;
+  uint8_t i = itemCount++;
+  for (; i > 0 && items[i - 1].layer > item.layer; i--) items[i] = items[i - 1];
+  items[i] = item;
+}
+
+void composeSpan(Layer layer, Region region, int first, int count, uint32_t color, uint8_t alpha) {
+  if (first < 0) {
+    count += first;
+    first = 0;
+  }
+  if (count <= 0) return;
+  ComposeItem item = { (uint8_t)layer, (uint8_t)region, alpha, (uint16_t)first, (uint16_t)count, NULL, color };
+  addItem(item);
+}
+
+void composeMask(Layer layer, Region region, const uint32_t *bits, uint32_t color, uint8_t alpha) {
+  ComposeItem item = { (uint8_t)layer, (uint8_t)region, alpha, 0, 0, bits, color };
+  addItem(item);
+}
+
+// The LEDs' light is linear in the PWM value, so the shares scale the
+// color linearly, without the gamma table, and the two LEDs of a dot add up
+// to one LED at full brightness
+static void composeShare(Layer layer, Region region, int pos, uint32_t color, uint16_t share) {
+  uint8_t light = share > 255 ? 255 : share;
+  composePixel(layer, region, pos, pixelScaleColor(color, light), light);
+}
+
+void composeDot(Layer layer, Region region, long pos, uint32_t color) {
+  long size = canvasSize(region);
+  pos = (pos % (size * POS_ONE) + size * POS_ONE) % (size * POS_ONE);
+  int led = pos / POS_ONE;
+  uint16_t next = pos % POS_ONE; // Share of the LED after led
+  composeShare(layer, region, led, color, POS_ONE - next);
+  if (next) composeShare(layer, region, (led + 1) % size, color, next);
+}
+
+// Blend src at alpha (0..255) into a pixel of color dst and coverage
+// (accumulated alpha) cover. Normal blending mixes with what is underneath
+// only: over an empty pixel a see-through item keeps its full color, since
+// an unlit LED is nothing rather than black. Adding saturates per channel.
+static uint32_t blend(uint32_t dst, uint8_t &cover, uint32_t src, uint8_t alpha, uint8_t mode) {
+  if (mode == BLEND_NORMAL && (alpha == 255 || cover == 0)) {
+    cover = alpha > cover ? alpha : cover;
+    return src;
+  }
+
+  // Weights of src and dst, out of the combined coverage
+  uint16_t below = (uint16_t)cover * (255 - alpha) / 255;
+  uint16_t total = alpha + below;
+  uint32_t out = 0;
+  for (uint8_t shift = 0; shift < 24; shift += 8) {
+    uint16_t s = (src >> shift) & 0xFF;
+    uint16_t d = (dst >> shift) & 0xFF;
+    d = mode == BLEND_ADD ? d + s * alpha / 255 : ((uint32_t)s * alpha + (uint32_t)d * below) / total;
+    out |= (uint32_t)(d > 255 ? 255 : d) << shift;
+  }
+  cover = total > 255 ? 255 : total;
+  return out;
+}
+
+static bool covers(const ComposeItem &item, uint16_t pos) {
+  if (item.mask) return item.mask[pos >> 5] & (1UL << (pos & 31));
+  return pos >= item.first && pos < item.first + item.count;
+}
+
+// The items of the region being painted, bottom layer first
+static const ComposeItem *regionItems[COMPOSE_MAX_ITEMS];
+static uint8_t regionItemCount;
+
+static uint32_t shadePixel(uint16_t pos) {
+  uint32_t color = 0;
+  uint8_t cover = 0;
+  for (uint8_t i = 0; i < regionItemCount; i++) {
+    const ComposeItem &item = *regionItems[i];
+    if (covers(item, pos)) color = blend(color, cover, item.color, item.alpha, layerBlend[item.layer]);
+  }
+  return color;
+}
+
+// First position after pos where the item may start or stop covering
+static uint16_t coverageChange(const ComposeItem &item, uint16_t pos, uint16_t size) {
+  if (!item.mask) {
+    if (pos < item.first) return item.first;
+    if (pos < item.first + item.count) return item.first + item.count;
+    return size;
+  }
+  // Next bit that differs from the one at pos, a word at a time
+  uint32_t flip = (item.mask[pos >> 5] >> (pos & 31)) & 1 ? 0xFFFFFFFFUL : 0;
+  uint16_t word = pos >> 5;
+  uint32_t bits = (item.mask[word] ^ flip) & (0xFFFFFFFFUL << (pos & 31));
+  while (!bits) {
+    if (++word * 32 >= size) return size;
+    bits = item.mask[word] ^ flip;
+  }
+  uint16_t change = word * 32 + __builtin_ctzl(bits);
+  return change < size ? change : size;
+}
+
+// Shade each run of positions covered by the same items once and fill it
+// with the pixel kernels; zones and bars are a few runs however big the
+// ring is
+void composeFlush() {
+  for (uint8_t region = 0; region < REGION_COUNT; region++) {
+    regionItemCount = 0;
+    for (uint8_t i = 0; i < itemCount; i++) {
+      if (items[i].region == region) regionItems[regionItemCount++] = &items[i];
+    }
+    uint16_t size = canvasSize((Region)region);
+    for (uint16_t pos = 0; pos < size;) {
+      uint16_t end = size;
+      for (uint8_t i = 0; i < regionItemCount; i++) {
+        uint16_t change = coverageChange(*regionItems[i], pos, size);
+        if (change < end) end = change;
+      }
+      canvasFillRange((Region)region, pos, end - pos, shadePixel(pos));
+      pos = end;
+    }
+  }
+  canvasFlush();
+}
@@ -0,0 +1,64 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include "canvas.h"
+
+// Layered compositor
+//
+// Draw code describes a frame as items on layers: a span of a region, or the
+// set bits of a mask over it, in one color at some opacity. composeFlush()
+// then splits every region into runs of pixels covered by the same items,
+// blends those items bottom layer first once per run and fills the run on
+// the canvas, so overlapping elements mix instead of the last writer
+// winning. An item is a few bytes; nothing is buffered per layer.
+
+enum BlendMode { BLEND_NORMAL, BLEND_ADD };
+
+// X(name, blend): z-order is the order of the list, bottom first
+#define COMPOSITOR_LAYERS(X)                                               \
+  X(BACKGROUND, BLEND_NORMAL) /* Clock face, HP and difficulty bars */     \
+  X(MARKS, BLEND_NORMAL)      /* Reaction target, drops */                 \
+  X(HANDS, BLEND_ADD)         /* Clock hands mix where they overlap */     \
+  X(PLAYER, BLEND_NORMAL)                                                  \
+  X(HAZARDS, BLEND_NORMAL)    /* Attack zones, the player shows through */
+
+#define COMPOSITOR_LAYER_ENUM(name, blend) LAYER_##name,
+enum Layer { COMPOSITOR_LAYERS(COMPOSITOR_LAYER_ENUM) LAYER_COUNT };
+#undef COMPOSITOR_LAYER_ENUM
+
+#define COMPOSE_MAX_ITEMS 12 // Items per frame, extra ones are not drawn
+
+// Palette (0xRRGGBB, as Adafruit_NeoPixel::Color() packs it); attack colors
+// are part of each pattern, see attacks.h
+#define COLOR_CLOCK_FACE 0xFFFFFFUL
+#define COLOR_HOUR_HAND 0xFF0000UL
+#define COLOR_MINUTE_HAND 0x00FF00UL
+#define COLOR_SECOND_HAND 0x0000FFUL
+#define COLOR_TARGET 0xFF0000UL
+#define COLOR_RUNNER 0xFFFF00UL
+#define COLOR_DIFFICULTY 0xFFFF00UL
+#define COLOR_PLAYER 0xFFFF00UL
+#define COLOR_DROP 0x0000FFUL
+#define COLOR_BOSS_HP 0xFF0000UL
+
+#define ALPHA_OPAQUE 255
+#define ALPHA_HAZARD 128 // Attack zones let the player show through
+
+void composeBegin(); // Start a frame with no items
+void composeSpan(Layer layer, Region region, int first, int count, uint32_t color,
+                 uint8_t alpha = ALPHA_OPAQUE);
+void composeMask(Layer layer, Region region, const uint32_t *bits, uint32_t color,
+                 uint8_t alpha = ALPHA_OPAQUE); // bits must live until composeFlush()
+void composeFlush(); // Blend every pixel once, then canvasFlush()
+
+// A dot at a sub-LED position (8.8 fixed point), shared between the two LEDs
+// it lies across. Each gets its share of the light, which adds up to the
+// same light wherever the dot is, and of alpha, so that it fades in over
+// what is underneath.
+void composeDot(Layer layer, Region region, long pos, uint32_t color);
+
+inline void composePixel(Layer layer, Region region, int pos, uint32_t color, uint8_t alpha = ALPHA_OPAQUE) {
+  composeSpan(layer, region, pos, 1, color, alpha);
+}
+
+#endif
@@ -0,0 +1,47 @@
+#include "framebuffer.h"
+#include "profiler.h"
+#include "framecap.h"
+#include "pixels.h"
+
+// Front buffers for both strips
+static uint8_t front1[STRIP1_LEDS * 3];
+static uint8_t front2[STRIP2_LEDS * 3];
+
+FrameBuffer frame1 = { &strip1, front1, false, 0, 0, 0, 0 };
+FrameBuffer frame2 = { &strip2, front2, false, 0, 0, 0, 0 };
+
+// Push the strip if its pixels differ from the last transmitted frame
+bool presentFrame(FrameBuffer &fb) {
+  const uint8_t *back = fb.strip->getPixels();
+  uint16_t pixels = fb.strip->numPixels();
+
+  if (fb.valid) {
+    uint16_t first, last;
+    if (!pixelDiff(fb.front, back, pixels, first, last)) {
+      fb.elided++;
+      return false;
+    }
+    fb.dirtyFirst = first;
+    fb.dirtyLast = last;
+    frameCapture(&fb == &frame2, fb.front, back, pixels);
+    memcpy(fb.front + 3 * first, back + 3 * first, 3 * (last - first + 1));
+  } else {
+    fb.dirtyFirst = 0;
+    fb.dirtyLast = pixels - 1;
+    frameCapture(&fb == &frame2, NULL, back, pixels);
+    memcpy(fb.front, back, 3 * pixels);
+    fb.valid = true;
+  }
+
+  {
+    PROFILE(PROF_SHOW);
+    fb.strip->show();
+  }
+  fb.pushes++;
+  return true;
+}
+
+// Force the next present to push, e.g. after writing to the strip directly
+void invalidateFrame(FrameBuffer &fb) {
+  fb.valid = false;
+}
@@ -0,0 +1,28 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include "settings.h"
+
+// Double-buffered strip output
+//
+// Modes draw into the strip's own pixel buffer (the back buffer). Presenting
+// compares it with the copy last transmitted (the front buffer) and only
+// calls show() when something changed, since every WS2812 push disables
+// interrupts for ~30 us per LED.
+struct FrameBuffer {
+  Adafruit_NeoPixel *strip;
+  uint8_t *front;         // GRB bytes as last pushed to the LEDs
+  bool valid;             // front matches what the LEDs show
+  uint16_t dirtyFirst;    // Pixel range that changed in the last push
+  uint16_t dirtyLast;
+  unsigned long pushes;
+  unsigned long elided;
+};
+
+extern FrameBuffer frame1;
+extern FrameBuffer frame2;
+
+bool presentFrame(FrameBuffer &fb);
+void invalidateFrame(FrameBuffer &fb);
+
+#endif
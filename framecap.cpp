@@ -0,0 +1,131 @@
+#include "framecap.h"
+#include "telemetry.h"
+
+// Per strip: when its last record went out and how far back its keyframe is
+struct StripCapture {
+  unsigned long lastMs;
+  uint8_t sinceKey;
+  bool synced; // The reader has a frame to apply deltas to
+};
+
+static const FrameSink *sink = NULL;
+static StripCapture strips[2];
+
+// Records are encoded twice: once to size them, once into the sink
+static bool sizing;
+static uint16_t size;
+static uint8_t checksum;
+
+static void emit(uint8_t b) {
+  if (sizing) {
+    size++;
+  } else {
+    sink->put(b);
+    checksum ^= b;
+  }
+}
+
+static void emitVarint(uint32_t v) {
+  while (v >= 0x80) {
+    emit(v | 0x80);
+    v >>= 7;
+  }
+  emit(v);
+}
+
+static void emitPixel(const uint8_t *p) {
+  emit(p[0]);
+  emit(p[1]);
+  emit(p[2]);
+}
+
+static bool samePixel(const uint8_t *a, const uint8_t *b) {
+  return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+}
+
+// Runs of equal pixels over the whole strip
+static void emitKeyframe(unsigned long ms, const uint8_t *cur, uint16_t pixels) {
+  for (uint8_t i = 0; i < 4; i++) emit(ms >> (8 * i));
+  emitVarint(pixels);
+  uint16_t i = 0;
+  while (i < pixels) {
+    uint16_t n = 1;
+    while (i + n < pixels && samePixel(cur + 3 * i, cur + 3 * (i + n))) n++;
+    emitVarint(n);
+    emitPixel(cur + 3 * i);
+    i += n;
+  }
+}
+
+// Runs of equal XOR differences, separated by unchanged stretches
+static void emitDelta(unsigned long dt, const uint8_t *prev, const uint8_t *cur, uint16_t pixels) {
+  emitVarint(dt);
+  uint16_t i = 0;
+  uint16_t skip = 0;
+  while (i < pixels) {
+    uint8_t x[3];
+    for (uint8_t c = 0; c < 3; c++) x[c] = prev[3 * i + c] ^ cur[3 * i + c];
+    if (!(x[0] | x[1] | x[2])) {
+      skip++;
+      i++;
+      continue;
+    }
+    uint16_t n = 1;
+    while (i + n < pixels) {
+      const uint8_t *p = prev + 3 * (i + n), *q = cur + 3 * (i + n);
+      if ((p[0] ^ q[0]) != x[0] || (p[1] ^ q[1]) != x[1] || (p[2] ^ q[2]) != x[2]) break;
+      n++;
+    }
+    emitVarint(skip);
+    emitVarint(n);
+    emitPixel(x);
+    skip = 0;
+    i += n;
+  }
+}
+
+static void emitBody(bool key, unsigned long ms, unsigned long dt, const uint8_t *prev, const uint8_t *cur,
+                     uint16_t pixels) {
+  if (key) emitKeyframe(ms, cur, pixels);
+  else emitDelta(dt, prev, cur, pixels);
+}
+
+void frameCapture(uint8_t strip, const uint8_t *prev, const uint8_t *cur, uint16_t pixels) {
+  if (!sink) return;
+  StripCapture &s = strips[strip];
+  unsigned long now = halMillis();
+  bool key = !prev || !s.synced || s.sinceKey >= FRAME_KEY_INTERVAL;
+
+  sizing = true;
+  size = 0;
+  emitBody(key, now, now - s.lastMs, prev, cur, pixels);
+  uint16_t body = size;
+
+  if (!sink->begin(1 + 3 + body + 1)) {
+    s.synced = false; // The next record has to stand on its own
+    return;
+  }
+  sizing = false;
+  sink->put(FRAME_SYNC);
+  checksum = 0;
+  emit((strip ? FRAME_KIND_STRIP2 : 0) | (key ? FRAME_KIND_KEY : 0));
+  emit(body);
+  emit(body >> 8);
+  emitBody(key, now, now - s.lastMs, prev, cur, pixels);
+  sink->put(checksum);
+
+  s.lastMs = now;
+  s.sinceKey = key ? 1 : s.sinceKey + 1;
+  s.synced = true;
+}
+
+void setFrameSink(const FrameSink *newSink) {
+  sink = newSink;
+  strips[0].synced = strips[1].synced = false; // Start the new stream with keyframes
+}
+
+const FrameSink *frameSink() {
+  return sink;
+}
+
+const FrameSink serialFrameSink = { telemetryBeginRaw, telemetryPutRaw };
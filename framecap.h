@@ -0,0 +1,51 @@
+#ifndef FRAMECAP_H
+#define FRAMECAP_H
+
+#include "hal.h"
+
+// Frame capture
+//
+// Every frame presentFrame() pushes can be streamed to a sink as a record
+// holding either the whole strip (a keyframe) or what changed since the
+// strip's previous record (a delta). Most frames move a pixel or two, so a
+// delta is about a dozen bytes. host/frameview plays a capture back in a
+// terminal.
+//
+// Record: 0x5A, kind, body length (16-bit LE), body, XOR checksum of
+// everything after the sync byte. kind bit 0 is the strip (0 = strip1),
+// bit 1 is set for a keyframe. Numbers marked varint are LEB128.
+//
+//   keyframe: millis (32-bit LE), pixel count (varint),
+//             runs of (length (varint), G, R, B) covering every pixel
+//   delta:    ms since the strip's previous record (varint),
+//             then up to the end of the body runs of (unchanged pixels
+//             to skip (varint), length (varint), G, R, B XORed into them)
+//
+// A strip sends a keyframe first, every FRAME_KEY_INTERVAL records and
+// whenever the sink refused a record, so a reader that joins late or lost
+// bytes is back in sync within a few frames. The stream can share the
+// serial line with telemetry: both decoders skip the other's records.
+
+#define FRAME_SYNC 0x5A
+#define FRAME_KIND_STRIP2 0x01
+#define FRAME_KIND_KEY 0x02
+#define FRAME_KEY_INTERVAL 50
+
+// Where records go. begin() is told the size of the whole record and
+// returns false to refuse it; otherwise put() receives every byte of it.
+struct FrameSink {
+  bool (*begin)(uint16_t bytes);
+  void (*put)(uint8_t b);
+};
+
+// The telemetry ring, so records go out over serial between events
+extern const FrameSink serialFrameSink;
+
+void setFrameSink(const FrameSink *sink); // NULL stops capturing
+const FrameSink *frameSink();
+
+// Called by presentFrame() before the strip is pushed; prev is the frame the
+// LEDs show now, NULL if unknown
+void frameCapture(uint8_t strip, const uint8_t *prev, const uint8_t *cur, uint16_t pixels);
+
+#endif
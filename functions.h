@@ -2,21 +2,49 @@
 #define FUNCTIONS_H
 
 #include "settings.h"
+#include "ring.h"
+#include "scheduler.h"
+#include "canvas.h"
+#include "compositor.h"
+#include "input.h"
+#include "attacks.h"
+#include "telemetry.h"
+#include "timekeeping.h"
+#include "rng.h"
+#include "state.h"
+#include "profiler.h"
+#include "persist.h"
+#include "framecap.h"
 
 // Clock mode functions
-void showClock();
+void resetClock();
+bool updateClock();
+void drawClock();
 void updateClockDisplay(int hours, int minutes, int seconds);
-void printClockTime(int hours, int minutes, int seconds);
+void logClockTime(int hours, int minutes, int seconds);
 
 // Reaction game functions
-void playReactionGame();
+void resetReaction();
+void newReactionAttempt();
+void endReaction();
+bool updateReaction();
+void drawReaction();
 void handleReactionInput(int pos, int target);
-void updateReactionDisplay(int target, int pos);
+void updateReactionDisplay(int target, long pos);
+void reactionStatsDump();
 
 // Boss fight - Main functions
-void playBossFight();
+void enterBossFight();
+void exitBossFight();
+bool updateBossFight();
 void resetBossFight();
+void suspendBossFight(BossSnapshot &s);
+bool resumeBossFight(const BossSnapshot &s);
+void simulateBossTick();
 void handlePlayerMovement();
+void updatePlayerSpeed();
+PlayerStride tickStride(uint16_t rate);
+uint16_t playerTravel(PlayerStride stride, uint16_t &carry);
 void handleAttackSystem();
 void handleDropSystem();
 void checkCollisions();
@@ -29,25 +57,24 @@ void drawDrops();
 
 // Boss fight - Attack system
 void startAttack();
+unsigned int tunedWarningMs(uint16_t warningMs, int hp);
 void updateAttack();
-void drawPhase1Attack();
-void drawPhase2Attack();
-void checkPhase1Collision();
-void checkPhase2Collision();
-void drawPhase1Warning();
-void drawPhase1Active();
-void drawPhase2Warning();
-void drawPhase2Active();
+void drawAttack();
+void drawAttackZones(uint32_t color);
+void checkAttackCollision();
 
 // Utility functions
-int wrapPosition(int pos);
 int findSafeDropPosition();
-void successFlash();
-void failFlash();
+void successFlash(TaskFn then = NULL);
+void failFlash(TaskFn then = NULL);
 void clearStrips();
 
 // Main program functions
 void handleModeSwitch();
+void handleSerialCommands();
+void captureModeState();
+void setMode(Mode mode);
+void runFrame();
 void runCurrentMode();
 void initializeHardware();
 void initializeGameState();
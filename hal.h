@@ -0,0 +1,46 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <Adafruit_NeoPixel.h>
+
+struct TimeSource;
+
+// Hardware abstraction layer
+//
+// Everything the modes need from the board goes through these calls so the
+// same mode code links against hal_avr.cpp on the Arduino and against
+// host/hal_host.cpp (virtual clock, scripted buttons) on Linux.
+// Strips keep the Adafruit_NeoPixel interface and logging keeps the Serial
+// Print interface; the host build supplies compatible implementations of both.
+
+// Clock
+unsigned long halMillis();
+unsigned long halMicros();
+void halDelay(unsigned long ms);
+
+// Input (buttons are active low with pull-ups on the board). The HAL reports
+// every change through inputEdge() from interrupt context, see input.h.
+void halInitInput();
+bool halButtonDown(uint8_t pin);
+
+// Entropy for the session seed (see rng.h)
+uint32_t halEntropy();
+
+// Battery-backed time source (see timekeeping.h)
+const TimeSource *halTimeSource();
+
+// EEPROM (see persist.h). A byte write takes ~3.4 ms in the background;
+// writing before halEepromReady() waits for the previous one to finish.
+uint8_t halEepromRead(uint16_t addr);
+bool halEepromReady();
+void halEepromWrite(uint16_t addr, uint8_t value); // Skipped if the byte already holds value
+
+// LEDs written by the pixel kernels (see pixels.h), which bypass
+// setPixelColor(); the host build counts them with its writes for bench
+#ifdef HOST_BUILD
+void halCountPixelWrites(uint32_t count);
+#else
+inline void halCountPixelWrites(uint32_t) {}
+#endif
+
+#endif
@@ -0,0 +1,68 @@
+#include <EEPROM.h>
+
+#include "settings.h"
+#include "hal.h"
+#include "input.h"
+#include "timekeeping.h"
+
+// Arduino implementation of the hardware abstraction layer
+
+// Clock
+unsigned long halMillis() {
+  return millis();
+}
+
+unsigned long halMicros() {
+  return micros();
+}
+
+void halDelay(unsigned long ms) {
+  delay(ms);
+}
+
+// Input (pins 2 and 3 are the external interrupt pins INT0/INT1)
+static void modeButtonIsr() {
+  inputEdge(BTN_MODE, !digitalRead(BTN_MODE), micros());
+}
+
+static void actionButtonIsr() {
+  inputEdge(BTN_ACTION, !digitalRead(BTN_ACTION), micros());
+}
+
+void halInitInput() {
+  pinMode(BTN_MODE, INPUT_PULLUP);
+  pinMode(BTN_ACTION, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(BTN_MODE), modeButtonIsr, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(BTN_ACTION), actionButtonIsr, CHANGE);
+}
+
+bool halButtonDown(uint8_t pin) {
+  return !digitalRead(pin);
+}
+
+// Entropy: the low bit of a floating analog pin, 32 samples
+uint32_t halEntropy() {
+  uint32_t seed = 0;
+  for (uint8_t i = 0; i < 32; i++) {
+    seed = (seed << 1) | (analogRead(A0) & 1);
+  }
+  return seed;
+}
+
+// Time source
+const TimeSource *halTimeSource() {
+  return &ds3231TimeSource;
+}
+
+// EEPROM
+uint8_t halEepromRead(uint16_t addr) {
+  return EEPROM.read(addr);
+}
+
+bool halEepromReady() {
+  return eeprom_is_ready();
+}
+
+void halEepromWrite(uint16_t addr, uint8_t value) {
+  EEPROM.update(addr, value);
+}
@@ -0,0 +1,67 @@
+#include "functions.h"
+
+// Valid bits of the last word (the ring rarely fills it exactly)
+static const uint32_t LAST_WORD_MASK =
+    (Arena::size % 32) ? (1UL << (Arena::size % 32)) - 1 : 0xFFFFFFFFUL;
+
+void hazardClear(HazardMap &map) {
+  for (int w = 0; w < HAZARD_WORDS; w++) map.bits[w] = 0;
+}
+
+// Set bits [first, first + count) without wrapping
+static void setRange(HazardMap &map, int first, int count) {
+  while (count > 0) {
+    int bit = first & 31;
+    int n = count < 32 - bit ? count : 32 - bit;
+    uint32_t mask = (n == 32) ? 0xFFFFFFFFUL : ((1UL << n) - 1) << bit;
+    map.bits[first >> 5] |= mask;
+    first += n;
+    count -= n;
+  }
+}
+
+// Mark a zone of the ring, wrapping past the last LED back to the first
+void hazardAddZone(HazardMap &map, int start, int width) {
+  if (width <= 0) return;
+  if (width > Arena::size) width = Arena::size;
+  start = wrapPosition(start);
+
+  int tail = start + width - Arena::size;
+  if (tail > 0) {
+    setRange(map, start, width - tail);
+    setRange(map, 0, tail);
+  } else {
+    setRange(map, start, width);
+  }
+}
+
+void hazardSet(HazardMap &map, int pos) {
+  map.bits[pos >> 5] |= 1UL << (pos & 31);
+}
+
+int hazardCount(const HazardMap &map) {
+  int count = 0;
+  for (int w = 0; w < HAZARD_WORDS; w++) count += __builtin_popcountl(map.bits[w]);
+  return count;
+}
+
+// Position of the n-th set bit (0-based), or -1 if there are fewer
+int hazardNth(const HazardMap &map, int n) {
+  for (int w = 0; w < HAZARD_WORDS; w++) {
+    uint32_t word = map.bits[w];
+    int count = __builtin_popcountl(word);
+    if (n >= count) {
+      n -= count;
+      continue;
+    }
+    while (n--) word &= word - 1; // Drop the lowest set bits
+    return (w << 5) + __builtin_ctzl(word);
+  }
+  return -1;
+}
+
+// Complement within the ring
+void hazardInvert(HazardMap &map) {
+  for (int w = 0; w < HAZARD_WORDS; w++) map.bits[w] = ~map.bits[w];
+  map.bits[HAZARD_WORDS - 1] &= LAST_WORD_MASK;
+}
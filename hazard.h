@@ -0,0 +1,31 @@
+#ifndef HAZARD_H
+#define HAZARD_H
+
+#include "ring.h"
+
+// Hazard bitmap over the play ring
+//
+// One bit per LED of the play ring, so a 24-LED ring is a single 32-bit word and
+// bigger rings just add words. startAttack() builds the map once per attack;
+// collision is then one AND, rendering walks the set bits and drop placement
+// picks from the clear ones.
+
+#define HAZARD_WORDS ((Arena::size + 31) / 32)
+
+struct HazardMap {
+  uint32_t bits[HAZARD_WORDS];
+};
+
+void hazardClear(HazardMap &map);
+void hazardAddZone(HazardMap &map, int start, int width);
+void hazardSet(HazardMap &map, int pos);
+int hazardCount(const HazardMap &map);
+int hazardNth(const HazardMap &map, int n);
+void hazardInvert(HazardMap &map);
+
+// Single-bit test, the per-frame collision check
+inline bool hazardTest(const HazardMap &map, int pos) {
+  return map.bits[pos >> 5] & (1UL << (pos & 31));
+}
+
+#endif
@@ -0,0 +1,398 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "../functions.h"
+#include "host.h"
+
+// Monte Carlo balancing for the boss fight.
+//
+//   balance [-j N] [--fights N] [--policy NAME] [--seed N] [--csv]
+//           [--sweep PARAM=FROM:TO:STEP ...]
+//
+// Plays many boss fights for every point of a grid over bossTuning and
+// reports, per point, how often the player wins, times out or dies, how long
+// a win takes, and which attack pattern the deaths come from. The fights run
+// on the real engine (runCurrentMode() at the 50 ms frame rate) with a scripted
+// player pressing the action button.
+//
+// The sketch keeps its state in globals, so workers are forked processes.
+// They steal batches of fights off a shared counter, so slow grid points do
+// not hold up the sweep. Every fight is seeded from (seed, grid point,
+// fight number), which makes results independent of the worker count.
+// Build with -DSTRIP1_LEDS=N to balance another ring size.
+
+void setup();
+
+static const unsigned long FRAME_MS = 50;
+static const unsigned long TIMEOUT_MS = 600000; // A fight this long counts as a timeout
+static const unsigned long HOLD_MS = 60;
+static const int BATCH = 250;                   // Fights per stolen task
+static const int TTK_BUCKETS = TIMEOUT_MS / 1000;
+static const int MAX_PATTERNS = 8;              // Death counters per point
+
+// Player policies
+enum Policy { POLICY_RANDOM, POLICY_GREEDY, POLICY_SLOPPY };
+static const char *const policyNames[] = { "random", "greedy", "sloppy" };
+
+struct PolicyParams {
+  unsigned long reactionMs; // How old the state the player acts on is
+  unsigned int missPct;     // Chance to miss a needed press
+};
+
+static const PolicyParams policyParams[] = {
+  { 0, 0 },     // random: presses at random, see playFight()
+  { 200, 0 },   // greedy: heads for the drop, dodges to the nearest safe LED
+  { 400, 20 },  // sloppy: the same, slower and missing now and then
+};
+
+// Sweepable parameters
+struct Param {
+  const char *name;
+  uint16_t BossTuning::*field16;
+  uint8_t BossTuning::*field8;
+  long max;
+};
+
+static const Param params[] = {
+  { "attackCooldown", &BossTuning::attackCooldownMs, nullptr, 0xFFFF },
+  { "phase2Cooldown", &BossTuning::phase2CooldownMs, nullptr, 0xFFFF },
+  { "dropCooldown", &BossTuning::dropCooldownMs, nullptr, 0xFFFF },
+  { "playerSpeed", &BossTuning::playerSpeed, nullptr, 0xFFFF },
+  { "phase2SpeedPct", nullptr, &BossTuning::phase2SpeedPct, 0xFF },
+  { "warningPct", nullptr, &BossTuning::warningPct, 100 }, // See tunedWarningMs()
+};
+static const int PARAM_COUNT = sizeof(params) / sizeof(params[0]);
+
+static long getParam(const BossTuning &t, int p) {
+  return params[p].field16 ? t.*params[p].field16 : t.*params[p].field8;
+}
+
+// False, leaving t alone, if value is out of the parameter's range
+static bool setParam(BossTuning &t, int p, long value) {
+  if (value < 0 || value > params[p].max) return false;
+  if (params[p].field16) t.*params[p].field16 = value;
+  else t.*params[p].field8 = value;
+  return true;
+}
+
+// Results of one grid point, in shared memory
+struct PointResult {
+  std::atomic<uint64_t> fights;
+  std::atomic<uint64_t> wins;
+  std::atomic<uint64_t> timeouts;
+  std::atomic<uint64_t> winMs;
+  std::atomic<uint64_t> deaths[MAX_PATTERNS];
+  std::atomic<uint32_t> ttk[TTK_BUCKETS]; // Wins by second
+};
+
+struct Shared {
+  std::atomic<uint64_t> nextTask;
+};
+
+// splitmix64, to derive one independent seed per fight
+static uint64_t mix(uint64_t x) {
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+struct PolicyRng {
+  uint64_t state;
+  uint32_t next() { return (uint32_t)((state = mix(state)) >> 32); }
+};
+
+// Distance to walk from `from` to `to` in the player's current direction
+static int stepsTo(int from, int to, int dir) {
+  return Arena::wrap((to - from) * dir);
+}
+
+// Direction the scripted player wants to walk in, or 0 for "keep going":
+// out of an attack the shortest way, back from its edge, else to the drop
+static int wantedDirection() {
+  const BossState &b = bossState;
+  int target = -1;
+  if (b.attackActive) {
+    if (!hazardTest(b.hazard, b.playerPos)) {
+      return hazardTest(b.hazard, Arena::wrap(b.playerPos + b.playerDir)) ? -b.playerDir : 0;
+    }
+    // Nearest safe LED either way
+    for (int d = 1; d < Arena::size && target < 0; d++) {
+      if (!hazardTest(b.hazard, Arena::wrap(b.playerPos + d))) target = Arena::wrap(b.playerPos + d);
+      else if (!hazardTest(b.hazard, Arena::wrap(b.playerPos - d))) target = Arena::wrap(b.playerPos - d);
+    }
+  } else if (b.dropActive) {
+    target = b.dropPos;
+  }
+  if (target < 0 || target == b.playerPos) return 0;
+  return stepsTo(b.playerPos, target, b.playerDir) <= stepsTo(b.playerPos, target, -b.playerDir)
+             ? b.playerDir
+             : -b.playerDir;
+}
+
+enum Outcome { OUTCOME_WIN, OUTCOME_DEATH, OUTCOME_TIMEOUT };
+
+// One fight from a fresh reset; returns how it ended and when
+static Outcome playFight(Policy policy, uint64_t seed, unsigned long &durationMs, uint8_t &killer) {
+  PolicyRng rng = { seed };
+
+  // Same starting point whatever ran before on this worker: button up and
+  // settled, clock on a whole second
+  stopEffect();
+  hostSetButton(BTN_ACTION, false);
+  hostClockAdvance(1000000);
+  pollInput();
+  hostClockAdvance(1000000 - hostClockMicros() % 1000000);
+  flushPresses(BTN_ACTION);
+  rngBegin((uint32_t)mix(seed ^ 0x5EED));
+  resetBossFight();
+
+  const PolicyParams &pp = policyParams[policy];
+  unsigned long start = halMillis();
+  unsigned long pressAt = 0, releaseAt = 0;
+  bool pending = false, held = false;
+
+  for (;;) {
+    hostClockAdvance(FRAME_MS * 1000);
+    unsigned long now = halMillis();
+
+    if (held && now >= releaseAt) {
+      hostSetButton(BTN_ACTION, false);
+      held = false;
+    }
+    if (pending && now >= pressAt && !held) {
+      hostSetButton(BTN_ACTION, true);
+      held = true;
+      pending = false;
+      releaseAt = now + HOLD_MS;
+    }
+    pollInput();
+    runCurrentMode();
+
+    if (effectRunning()) {
+      durationMs = now - start;
+      if (bossState.bossHP <= 0) return OUTCOME_WIN;
+      killer = bossState.attackPattern;
+      return OUTCOME_DEATH;
+    }
+    if (now - start >= TIMEOUT_MS) {
+      durationMs = now - start;
+      return OUTCOME_TIMEOUT;
+    }
+
+    // Decide on a press; it lands after the player's reaction time
+    if (pending || held) continue;
+    bool press;
+    if (policy == POLICY_RANDOM) {
+      press = rng.next() % 20 == 0; // About one press a second
+    } else {
+      int dir = wantedDirection();
+      press = dir != 0 && dir != bossState.playerDir && rng.next() % 100 >= pp.missPct;
+    }
+    if (press) {
+      pending = true;
+      pressAt = now + pp.reactionMs;
+    }
+  }
+}
+
+static void runWorker(Shared *shared, PointResult *results, const std::vector<BossTuning> &grid,
+                      int fightsPerPoint, Policy policy, uint64_t seed) {
+  hostSetSerialSink(nullptr);
+  setup();
+  setTelemetryLevel(TLM_WARN);
+  setMode(BOSS_MODE);
+
+  uint64_t batches = (fightsPerPoint + BATCH - 1) / BATCH;
+  uint64_t tasks = grid.size() * batches;
+  for (;;) {
+    uint64_t task = shared->nextTask.fetch_add(1);
+    if (task >= tasks) return;
+    size_t point = task / batches;
+    int first = (task % batches) * BATCH;
+    int last = first + BATCH < fightsPerPoint ? first + BATCH : fightsPerPoint;
+
+    bossTuning = grid[point];
+    uint64_t wins = 0, timeouts = 0, winMs = 0;
+    uint64_t deaths[MAX_PATTERNS] = {};
+    for (int f = first; f < last; f++) {
+      unsigned long ms = 0;
+      uint8_t killer = 0;
+      switch (playFight(policy, mix(seed ^ mix(point << 32 | f)), ms, killer)) {
+        case OUTCOME_WIN:
+          wins++;
+          winMs += ms;
+          results[point].ttk[ms / 1000 < TTK_BUCKETS ? ms / 1000 : TTK_BUCKETS - 1]++;
+          break;
+        case OUTCOME_DEATH: deaths[killer]++; break;
+        case OUTCOME_TIMEOUT: timeouts++; break;
+      }
+    }
+    PointResult &r = results[point];
+    r.fights += last - first;
+    r.wins += wins;
+    r.timeouts += timeouts;
+    r.winMs += winMs;
+    for (int p = 0; p < MAX_PATTERNS; p++) r.deaths[p] += deaths[p];
+  }
+}
+
+// Seconds below which `fraction` of the wins fall
+static double ttkPercentile(const PointResult &r, double fraction) {
+  uint64_t wins = r.wins, seen = 0;
+  if (!wins) return 0;
+  for (int s = 0; s < TTK_BUCKETS; s++) {
+    seen += r.ttk[s];
+    if (seen >= fraction * wins) return s + 1;
+  }
+  return TTK_BUCKETS;
+}
+
+static void usage() {
+  fprintf(stderr,
+          "usage: balance [options]\n"
+          "  -j N                      worker processes (default: all CPUs)\n"
+          "  --fights N                fights per grid point (default 10000)\n"
+          "  --policy random|greedy|sloppy  scripted player (default greedy)\n"
+          "  --seed N                  base seed (default 1)\n"
+          "  --sweep PARAM=FROM:TO:STEP  add a grid axis, repeatable; PARAM is one of\n"
+          "                            attackCooldown phase2Cooldown dropCooldown\n"
+          "                            playerSpeed (8.8) phase2SpeedPct warningPct (<= 100)\n"
+          "  --csv                     machine-readable output\n");
+}
+
+int main(int argc, char **argv) {
+  int jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  int fightsPerPoint = 10000;
+  Policy policy = POLICY_GREEDY;
+  uint64_t seed = 1;
+  bool csv = false;
+  std::vector<BossTuning> grid = { bossTuning };
+  std::vector<int> swept;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+    if (!strcmp(arg, "-j") && val) {
+      jobs = atoi(val);
+      i++;
+    } else if (!strcmp(arg, "--fights") && val) {
+      fightsPerPoint = atoi(val);
+      i++;
+    } else if (!strcmp(arg, "--policy") && val) {
+      int p = 0;
+      while (p < 3 && strcmp(val, policyNames[p])) p++;
+      if (p == 3) { usage(); return 2; }
+      policy = (Policy)p;
+      i++;
+    } else if (!strcmp(arg, "--seed") && val) {
+      seed = strtoull(val, NULL, 0);
+      i++;
+    } else if (!strcmp(arg, "--sweep") && val) {
+      const char *eq = strchr(val, '=');
+      long from, to, step;
+      int p = 0;
+      while (eq && p < PARAM_COUNT && strncmp(val, params[p].name, eq - val)) p++;
+      if (!eq || p == PARAM_COUNT || sscanf(eq + 1, "%ld:%ld:%ld", &from, &to, &step) != 3 || step <= 0) {
+        usage();
+        return 2;
+      }
+      std::vector<BossTuning> expanded;
+      for (const BossTuning &t : grid) {
+        for (long v = from; v <= to; v += step) {
+          BossTuning point = t;
+          if (!setParam(point, p, v)) {
+            fprintf(stderr, "balance: %s goes from 0 to %ld\n", params[p].name, params[p].max);
+            return 2;
+          }
+          expanded.push_back(point);
+        }
+      }
+      grid = expanded;
+      swept.push_back(p);
+      i++;
+    } else if (!strcmp(arg, "--csv")) {
+      csv = true;
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (jobs < 1) jobs = 1;
+  if (attackPatternCount > MAX_PATTERNS) {
+    fprintf(stderr, "more than %d attack patterns\n", MAX_PATTERNS);
+    return 1;
+  }
+
+  size_t bytes = sizeof(Shared) + grid.size() * sizeof(PointResult);
+  void *mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  memset(mem, 0, bytes); // Zeroed atomics
+  Shared *shared = (Shared *)mem;
+  PointResult *results = (PointResult *)(shared + 1);
+
+  auto wallStart = std::chrono::steady_clock::now();
+  for (int w = 0; w < jobs; w++) {
+    pid_t pid = fork();
+    if (pid < 0) {
+      perror("fork");
+      return 1;
+    }
+    if (pid == 0) {
+      runWorker(shared, results, grid, fightsPerPoint, policy, seed);
+      _exit(0);
+    }
+  }
+  int status, failed = 0;
+  while (wait(&status) > 0) {
+    if (!WIFEXITED(status) || WEXITSTATUS(status)) failed++;
+  }
+  double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  if (failed) {
+    fprintf(stderr, "%d workers failed\n", failed);
+    return 1;
+  }
+
+  if (csv) {
+    for (int p : swept) printf("%s,", params[p].name);
+    printf("fights,win_pct,timeout_pct,ttk_mean_s,ttk_p50_s,ttk_p90_s");
+    for (int a = 0; a < attackPatternCount; a++) printf(",death_pct_%d", a);
+    printf("\n");
+  } else {
+    printf("ring %d LEDs, policy %s, %d fights per point\n\n", Arena::size, policyNames[policy],
+           fightsPerPoint);
+    for (int p : swept) printf("%15s ", params[p].name);
+    printf("%8s %7s %7s %8s %6s %6s  deaths by pattern %%\n", "fights", "win%", "timeout", "ttk avg",
+           "p50", "p90");
+  }
+
+  for (size_t i = 0; i < grid.size(); i++) {
+    const PointResult &r = results[i];
+    double fights = r.fights ? (double)r.fights : 1;
+    double wins = r.wins;
+    const char *sep = csv ? "," : " ";
+    for (int p : swept) printf(csv ? "%ld," : "%15ld ", getParam(grid[i], p));
+    printf(csv ? "%llu,%.2f,%.2f,%.1f,%.0f,%.0f" : "%8llu %6.2f%% %6.2f%% %7.1fs %5.0fs %5.0fs ",
+           (unsigned long long)r.fights, 100 * wins / fights, 100 * r.timeouts / fights,
+           wins ? r.winMs / wins / 1000 : 0.0, ttkPercentile(r, 0.5), ttkPercentile(r, 0.9));
+    for (int a = 0; a < attackPatternCount; a++) printf("%s%.2f", sep, 100 * r.deaths[a] / fights);
+    printf("\n");
+  }
+
+  uint64_t total = 0;
+  for (size_t i = 0; i < grid.size(); i++) total += results[i].fights;
+  fprintf(stderr, "\n%llu fights on %d workers in %.1f s (%.0f fights/s)\n", (unsigned long long)total,
+          jobs, wallS, total / wallS);
+  return 0;
+}
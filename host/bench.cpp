@@ -0,0 +1,503 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../functions.h"
+#include "host.h"
+
+// Frame-cost benchmarks for every mode on the host build.
+//
+//   bench [--frames N] [--filter TEXT] [--baseline FILE] > results.json
+//
+// Each scenario pins the game in one state (mode, boss HP, phase, attack
+// pattern and window) and runs its update+render path for N frames, restoring
+// the pinned state before every frame. Output is one JSON object per line;
+// --baseline compares against an earlier run and prints the change per
+// scenario on stderr.
+//
+// The pixels/* scenarios time each pixel kernel (pixels.h) over a ring of
+// BIG_RING LEDs against the same work done with one getPixelColor() /
+// setPixelColor() call per pixel.
+//
+// The difficulty/* scenarios count the soft-float calls a 50 ms boss frame
+// made when its HP and speed scaled timings were float math redone every
+// frame (float), against the five ticks of simulateBossTick() that cover the
+// same 50 ms now (integer).
+
+void setup();
+
+// Allocation counting (the bench is linked with --wrap for these)
+static uint64_t allocations = 0;
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *p, size_t size);
+void *__wrap_malloc(size_t size) {
+  allocations++;
+  return __real_malloc(size);
+}
+void *__wrap_calloc(size_t n, size_t size) {
+  allocations++;
+  return __real_calloc(n, size);
+}
+void *__wrap_realloc(void *p, size_t size) {
+  allocations++;
+  return __real_realloc(p, size);
+}
+}
+
+typedef void (*Stage)();
+
+struct Scenario {
+  std::string name;
+  uint64_t frameMicros;                  // Virtual time per frame
+  void (*pin)();                         // Restore the pinned state (untimed)
+  std::vector<std::pair<const char *, Stage>> stages;
+};
+
+// libgcc routines the ATmega calls for float math (double is float there)
+#define SOFT_FLOAT_OPS(X) \
+  X(ADD, "__addsf3")      /* and __subsf3 */ \
+  X(MUL, "__mulsf3")                         \
+  X(DIV, "__divsf3")                         \
+  X(CMP, "__gtsf2")       /* and the other compares */ \
+  X(FLOAT, "__floatsisf") /* integer to float, signed or not */ \
+  X(FIX, "__fixsfsi")     /* float to integer, signed or not */
+
+#define SOFT_FLOAT_ENUM(name, routine) SF_##name,
+enum SoftFloatOp { SOFT_FLOAT_OPS(SOFT_FLOAT_ENUM) SF_COUNT };
+#undef SOFT_FLOAT_ENUM
+
+static uint64_t softFloatCalls[SF_COUNT];
+
+struct Result {
+  double nsPerFrame;
+  double softFloatPerFrame[SF_COUNT];
+  std::map<std::string, double> stageNs;
+  double allocsPerFrame;
+  double pixelWritesPerFrame;
+  double showsPerFrame;
+};
+
+static int frames = 20000;
+static const int RUNS = 5; // Best of
+
+// Scenario parameters read by the pin functions
+static int pinnedHP;
+static bool pinnedPhase2;
+static int pinnedPattern;   // -1: no attack
+static bool pinnedHitWindow;
+static int pinnedPlayer;
+static int pinnedDifficulty;
+
+static void pinBoss() {
+  stopEffect();
+  bossState.bossHP = pinnedHP;
+  bossState.phase2 = pinnedPhase2;
+  bossState.playerPos = pinnedPlayer;
+  bossState.playerFixed = (long)pinnedPlayer * POS_ONE;
+  bossState.dropActive = pinnedPattern < 0;
+  bossState.attackActive = pinnedPattern >= 0;
+  bossState.simMs = halMillis(); // The stages below run as one tick at this time
+  bossState.fightStartTime = bossState.simMs - BOSS_INITIAL_DELAY_MS - 1;
+  bossState.lastAttackTime = bossState.simMs; // No new attack starts by itself
+  if (bossState.attackActive) {
+    bossState.attackStartTime = bossState.simMs - (pinnedHitWindow ? bossState.attackWarningMs + 10 : 10);
+    bossState.attackBlinkOn = false; // Caught up by the next tick
+    bossState.attackBlinkMs = 0;
+  }
+}
+
+static void pinReaction() {
+  stopEffect();
+  if (reactionState.difficulty == pinnedDifficulty) return;
+  reactionState.difficulty = pinnedDifficulty;
+  newReactionAttempt(); // At its speed
+}
+
+static void pinNothing() {}
+
+static void nothing() {}
+
+// Start an attack of the wanted pattern with the player on a safe LED
+static void prepareBoss() {
+  resetBossFight();
+  bossState.bossHP = pinnedHP;
+  bossState.phase2 = pinnedPhase2;
+  updatePlayerSpeed();
+  bossState.attackActive = false;
+  if (pinnedPattern < 0) {
+    pinnedPlayer = 0;
+    bossState.dropPos = STRIP1_LEDS / 2;
+    return;
+  }
+  bossState.playerPos = 0;
+  do {
+    startAttack();
+  } while (bossState.attackPattern != pinnedPattern);
+  pinnedPlayer = 0;
+  while (hazardTest(bossState.hazard, pinnedPlayer)) pinnedPlayer++;
+}
+
+static double nowNs() {
+  return std::chrono::duration<double, std::nano>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Best-of-RUNS time for `frames` frames of pin + stages, in ns per frame
+static double timeFrames(const Scenario &s, const std::vector<Stage> &stages) {
+  double best = 1e30;
+  for (int run = 0; run < RUNS; run++) {
+    double start = nowNs();
+    for (int f = 0; f < frames; f++) {
+      hostClockAdvance(s.frameMicros);
+      s.pin();
+      for (Stage stage : stages) stage();
+    }
+    double ns = (nowNs() - start) / frames;
+    if (ns < best) best = ns;
+  }
+  return best;
+}
+
+static Result runScenario(const Scenario &s) {
+  Result r;
+  std::vector<Stage> all;
+  for (auto &stage : s.stages) all.push_back(stage.second);
+
+  double overhead = timeFrames(s, { nothing });
+  uint64_t allocsBefore = allocations;
+  uint64_t writesBefore = hostPixelWrites();
+  uint32_t showsBefore = hostShowCount();
+  uint64_t softFloatBefore[SF_COUNT];
+  memcpy(softFloatBefore, softFloatCalls, sizeof(softFloatCalls));
+  r.nsPerFrame = timeFrames(s, all) - overhead;
+  double counted = (double)frames * RUNS;
+  for (int op = 0; op < SF_COUNT; op++) r.softFloatPerFrame[op] = (softFloatCalls[op] - softFloatBefore[op]) / counted;
+  r.allocsPerFrame = (allocations - allocsBefore) / counted;
+  r.pixelWritesPerFrame = (hostPixelWrites() - writesBefore) / counted;
+  r.showsPerFrame = (hostShowCount() - showsBefore) / counted;
+
+  if (s.stages.size() > 1) {
+    for (auto &stage : s.stages) r.stageNs[stage.first] = timeFrames(s, { stage.second }) - overhead;
+  }
+  if (r.nsPerFrame < 0) r.nsPerFrame = 0;
+  return r;
+}
+
+// Pixel kernels against per-pixel calls, on two big rings
+#define BIG_RING 1024
+static Adafruit_NeoPixel bigRing(BIG_RING, 90, NEO_GRB + NEO_KHZ800);
+static Adafruit_NeoPixel bigRing2(BIG_RING, 91, NEO_GRB + NEO_KHZ800);
+static uint8_t pinnedRing[BIG_RING * 3], pinnedRing2[BIG_RING * 3];
+static uint8_t xorOut[BIG_RING * 3];
+static uint8_t naiveGamma[256];
+static volatile uint16_t diffSink;
+
+// Something to scale, add and compare: a gradient, and a copy with one
+// differing LED. Restored with a memcpy, which the overhead run subtracts.
+static void pinPixels() {
+  memcpy(bigRing.getPixels(), pinnedRing, sizeof(pinnedRing));
+  memcpy(bigRing2.getPixels(), pinnedRing2, sizeof(pinnedRing2));
+}
+
+static void kernelFill() { pixelFill(bigRing.getPixels(), BIG_RING, 0xFF8000); }
+static void naiveFill() {
+  for (int i = 0; i < BIG_RING; i++) bigRing.setPixelColor(i, 0xFF8000);
+}
+static void kernelFillWrap() { pixelFillWrap(bigRing.getPixels(), BIG_RING, BIG_RING - 100, 300, 0xFF8000); }
+static void naiveFillWrap() {
+  for (int i = 0; i < 300; i++) bigRing.setPixelColor((BIG_RING - 100 + i) % BIG_RING, 0xFF8000);
+}
+static void kernelScale() { pixelScale(bigRing.getPixels(), BIG_RING, 128); }
+static void naiveScale() {
+  for (int i = 0; i < BIG_RING; i++) {
+    uint32_t c = bigRing.getPixelColor(i);
+    bigRing.setPixelColor(i, ((c >> 16 & 0xFF) * 129) >> 8, ((c >> 8 & 0xFF) * 129) >> 8, ((c & 0xFF) * 129) >> 8);
+  }
+}
+static void kernelGamma() { pixelGamma(bigRing.getPixels(), BIG_RING); }
+static void naiveGammaLoop() {
+  for (int i = 0; i < BIG_RING; i++) {
+    uint32_t c = bigRing.getPixelColor(i);
+    bigRing.setPixelColor(i, naiveGamma[c >> 16 & 0xFF], naiveGamma[c >> 8 & 0xFF], naiveGamma[c & 0xFF]);
+  }
+}
+static void kernelAdd() { pixelAdd(bigRing.getPixels(), bigRing2.getPixels(), BIG_RING); }
+static void naiveAdd() {
+  for (int i = 0; i < BIG_RING; i++) {
+    uint32_t a = bigRing.getPixelColor(i), b = bigRing2.getPixelColor(i);
+    uint8_t out[3];
+    for (int c = 0; c < 3; c++) {
+      int sum = (a >> (8 * c) & 0xFF) + (b >> (8 * c) & 0xFF);
+      out[c] = sum > 255 ? 255 : sum;
+    }
+    bigRing.setPixelColor(i, out[2], out[1], out[0]);
+  }
+}
+static void kernelXor() { pixelXor(xorOut, bigRing.getPixels(), bigRing2.getPixels(), BIG_RING); }
+static void naiveXor() {
+  for (int i = 0; i < BIG_RING; i++) {
+    uint32_t x = bigRing.getPixelColor(i) ^ bigRing2.getPixelColor(i);
+    xorOut[3 * i] = x >> 8;
+    xorOut[3 * i + 1] = x >> 16;
+    xorOut[3 * i + 2] = x;
+  }
+}
+static void kernelDiff() {
+  uint16_t first = 0, last = 0;
+  pixelDiff(bigRing.getPixels(), bigRing2.getPixels(), BIG_RING, first, last);
+  diffSink = first + last;
+}
+static void naiveDiff() {
+  int first = 0, last = BIG_RING - 1;
+  while (first < BIG_RING && bigRing.getPixelColor(first) == bigRing2.getPixelColor(first)) first++;
+  while (last > first && bigRing.getPixelColor(last) == bigRing2.getPixelColor(last)) last--;
+  diffSink = first + last;
+}
+
+static void addPixelScenarios(std::vector<Scenario> &list) {
+  for (int i = 0; i < 256; i++) naiveGamma[i] = (uint8_t)lround(pow(i / 255.0, 2.6) * 255);
+  for (int i = 0; i < BIG_RING; i++) {
+    bigRing.setPixelColor(i, (i * 7) & 0xFF, (i * 3) & 0xFF, i & 0xFF);
+    bigRing2.setPixelColor(i, bigRing.getPixelColor(i));
+  }
+  bigRing2.setPixelColor(BIG_RING / 2, 0x123456);
+  memcpy(pinnedRing, bigRing.getPixels(), sizeof(pinnedRing));
+  memcpy(pinnedRing2, bigRing2.getPixels(), sizeof(pinnedRing2));
+  static const struct {
+    const char *name;
+    Stage kernel, naive;
+  } kernels[] = {
+    { "fill", kernelFill, naiveFill },   { "fill-wrap", kernelFillWrap, naiveFillWrap },
+    { "scale", kernelScale, naiveScale }, { "gamma", kernelGamma, naiveGammaLoop },
+    { "add", kernelAdd, naiveAdd },       { "xor", kernelXor, naiveXor },
+    { "diff", kernelDiff, naiveDiff },
+  };
+  for (const auto &k : kernels) {
+    list.push_back({ std::string("pixels/") + k.name + "/kernel", 0, pinPixels, { { "kernel", k.kernel } } });
+    list.push_back({ std::string("pixels/") + k.name + "/naive", 0, pinPixels, { { "naive", k.naive } } });
+  }
+}
+
+// A float that counts the soft-float call behind every operation, as
+// written (a compiler may share a repeated conversion). Constants cost
+// nothing; conversions from and to integers are explicit.
+struct SoftFloat {
+  float v;
+  SoftFloat(float f) : v(f) {}
+  static SoftFloat from(long i) {
+    softFloatCalls[SF_FLOAT]++;
+    return SoftFloat((float)i);
+  }
+  long toLong() const {
+    softFloatCalls[SF_FIX]++;
+    return (long)v;
+  }
+};
+
+static SoftFloat operator+(SoftFloat a, SoftFloat b) { softFloatCalls[SF_ADD]++; return a.v + b.v; }
+static SoftFloat operator-(SoftFloat a, SoftFloat b) { softFloatCalls[SF_ADD]++; return a.v - b.v; }
+static SoftFloat operator*(SoftFloat a, SoftFloat b) { softFloatCalls[SF_MUL]++; return a.v * b.v; }
+static SoftFloat operator/(SoftFloat a, SoftFloat b) { softFloatCalls[SF_DIV]++; return a.v / b.v; }
+static bool operator>(SoftFloat a, SoftFloat b) { softFloatCalls[SF_CMP]++; return a.v > b.v; }
+
+static volatile long timingSink;
+static unsigned long lastFlashMs;
+
+// The per-frame timing of handlePlayerMovement(), drawAttack() and
+// checkCollisions() as it was in float: speed in LEDs per second, warning
+// and blink scaled by the HP ratio every time they were needed
+static SoftFloat floatHpRatio() {
+  return SoftFloat::from(bossState.bossHP) / SoftFloat(STRIP2_LEDS);
+}
+
+static unsigned long floatWarningMs() {
+  SoftFloat scale = SoftFloat(0.5f) + SoftFloat(0.5f) * floatHpRatio();
+  return (SoftFloat::from(bossState.attack.warningMs) * scale).toLong();
+}
+
+static void floatMovement() {
+  SoftFloat speed = SoftFloat((float)bossTuning.playerSpeed / SPEED_ONE);
+  if (bossState.phase2) speed = speed * SoftFloat(1.5f);
+  timingSink = SoftFloat::from(bossState.simMs - bossState.attackStartTime) > SoftFloat(1000.0f) / speed;
+}
+
+static void floatAttack() {
+  if (!bossState.attackActive) return;
+  unsigned long elapsed = bossState.simMs - bossState.attackStartTime;
+  if (elapsed < floatWarningMs()) {
+    SoftFloat flashMs = SoftFloat::from(bossState.attack.flashMs);
+    long flashSpeed = (SoftFloat::from(bossState.attack.flashMs) + flashMs * (SoftFloat(1.0f) - floatHpRatio())).toLong();
+    timingSink = bossState.simMs - lastFlashMs > (unsigned long)flashSpeed;
+  }
+}
+
+static void floatCollisions() {
+  if (bossState.attackActive) timingSink = bossState.simMs - bossState.attackStartTime >= floatWarningMs();
+}
+
+// The same 50 ms now: the ticks the fight runs, as it ships, and the blink
+// drawAttack() reads
+static void integerTicks() {
+  for (int tick = 0; tick < 50 / SIM_TICK_MS; tick++) {
+    bossState.simMs += SIM_TICK_MS;
+    simulateBossTick();
+  }
+  timingSink = bossState.attackBlinkOn;
+}
+
+static void addDifficultyScenarios(std::vector<Scenario> &list) {
+  static const char *const states[] = { "hp8/phase1/idle", "hp8/phase1/walls/warning", "hp8/phase1/walls/hit",
+                                        "hp4/phase2/idle", "hp4/phase2/hourglass/warning",
+                                        "hp4/phase2/hourglass/hit" };
+  for (const char *state : states) {
+    list.push_back({ std::string("difficulty/") + state + "/float", 50000, pinBoss,
+                     { { "movement", floatMovement }, { "attack", floatAttack }, { "collisions", floatCollisions } } });
+    list.push_back({ std::string("difficulty/") + state + "/integer", 50000, pinBoss,
+                     { { "ticks", integerTicks } } });
+  }
+}
+
+static std::vector<Scenario> buildScenarios() {
+  std::vector<Scenario> list;
+  static const char *const patternNames[] = { "walls", "hourglass", "double-walls", "triple" };
+  std::vector<std::pair<const char *, Stage>> bossStages = {
+    { "movement", handlePlayerMovement }, { "attack", handleAttackSystem },
+    { "drops", handleDropSystem },        { "render", drawBossFightDisplay },
+    { "collisions", checkCollisions },
+  };
+
+  list.push_back({ "clock", 50000, pinNothing, { { "frame", runCurrentMode } } });
+  for (int d = 0; d < STRIP2_LEDS; d++) {
+    list.push_back({ "reaction/difficulty" + std::to_string(d), 1000, pinReaction,
+                     { { "frame", runCurrentMode } } });
+  }
+  for (int hp = STRIP2_LEDS; hp >= 1; hp--) {
+    for (int phase = 1; phase <= 2; phase++) {
+      std::string prefix = "boss/hp" + std::to_string(hp) + "/phase" + std::to_string(phase);
+      list.push_back({ prefix + "/idle", 50000, pinBoss, bossStages });
+      for (int p = 0; p < attackPatternCount; p++) {
+        AttackPattern pattern;
+        memcpy(&pattern, &attackPatterns[p], sizeof(pattern));
+        if (pattern.phase != phase) continue;
+        for (int hit = 0; hit <= 1; hit++) {
+          list.push_back({ prefix + "/" + (p < 4 ? patternNames[p] : std::to_string(p)) +
+                               (hit ? "/hit" : "/warning"),
+                           50000, pinBoss, bossStages });
+        }
+      }
+    }
+  }
+  addDifficultyScenarios(list);
+  addPixelScenarios(list);
+  return list;
+}
+
+// Set the scenario parameters encoded in its name
+static void configure(const std::string &name) {
+  if (name.compare(0, 7, "pixels/") == 0) {
+    return; // Nothing of the game is involved
+  } else if (name == "clock") {
+    setMode(CLOCK_MODE);
+  } else if (name.compare(0, 8, "reaction") == 0) {
+    setMode(REACTION_MODE);
+    pinnedDifficulty = atoi(name.c_str() + name.find("difficulty") + 10);
+  } else {
+    if (currentMode != BOSS_MODE) setMode(BOSS_MODE);
+    pinnedHP = atoi(name.c_str() + name.find("/hp") + 3);
+    pinnedPhase2 = name.find("/phase2") != std::string::npos;
+    pinnedHitWindow = name.find("/hit") != std::string::npos;
+    pinnedPattern = -1;
+    static const char *const patternNames[] = { "/walls/", "/hourglass/", "/double-walls/", "/triple/" };
+    for (int p = 0; p < 4; p++) {
+      if (name.find(patternNames[p]) != std::string::npos) pinnedPattern = p;
+    }
+    prepareBoss();
+  }
+}
+
+static std::map<std::string, double> loadBaseline(const char *path) {
+  std::map<std::string, double> baseline;
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    perror(path);
+    exit(2);
+  }
+  char line[1024], name[256];
+  double ns;
+  while (fgets(line, sizeof(line), f)) {
+    if (sscanf(line, "{\"scenario\": \"%255[^\"]\", \"ns_per_frame\": %lf", name, &ns) == 2)
+      baseline[name] = ns;
+  }
+  fclose(f);
+  return baseline;
+}
+
+int main(int argc, char **argv) {
+  const char *filter = NULL;
+  const char *baselinePath = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--frames") && i + 1 < argc) frames = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--filter") && i + 1 < argc) filter = argv[++i];
+    else if (!strcmp(argv[i], "--baseline") && i + 1 < argc) baselinePath = argv[++i];
+    else {
+      fprintf(stderr, "usage: bench [--frames N] [--filter TEXT] [--baseline FILE]\n");
+      return 2;
+    }
+  }
+  std::map<std::string, double> baseline;
+  if (baselinePath) baseline = loadBaseline(baselinePath);
+
+  hostSetSerialSink(nullptr);
+  hostSeedRandom(1);
+  setup();
+  fprintf(stderr, "pixel kernels: %s\n", pixelKernels());
+
+  for (const Scenario &s : buildScenarios()) {
+    if (filter && s.name.find(filter) == std::string::npos) continue;
+    configure(s.name);
+    Result r = runScenario(s);
+
+    printf("{\"scenario\": \"%s\", \"ns_per_frame\": %.1f, \"allocs_per_frame\": %.2f, "
+           "\"pixel_writes_per_frame\": %.1f, \"shows_per_frame\": %.3f",
+           s.name.c_str(), r.nsPerFrame, r.allocsPerFrame, r.pixelWritesPerFrame, r.showsPerFrame);
+    if (s.name.compare(0, 11, "difficulty/") == 0) {
+      static const char *const routines[] = {
+#define SOFT_FLOAT_NAME(name, routine) routine,
+        SOFT_FLOAT_OPS(SOFT_FLOAT_NAME)
+#undef SOFT_FLOAT_NAME
+      };
+      double total = 0;
+      for (int op = 0; op < SF_COUNT; op++) total += r.softFloatPerFrame[op];
+      printf(", \"soft_float_calls_per_frame\": %.1f, \"soft_float\": {", total);
+      for (int op = 0; op < SF_COUNT; op++) {
+        printf("%s\"%s\": %.1f", op ? ", " : "", routines[op], r.softFloatPerFrame[op]);
+      }
+      printf("}");
+    }
+    if (!r.stageNs.empty()) {
+      printf(", \"stage_ns\": {");
+      const char *sep = "";
+      for (auto &stage : s.stages) {
+        printf("%s\"%s\": %.1f", sep, stage.first, r.stageNs[stage.first] < 0 ? 0 : r.stageNs[stage.first]);
+        sep = ", ";
+      }
+      printf("}");
+    }
+    printf("}\n");
+    fflush(stdout);
+
+    auto old = baseline.find(s.name);
+    if (old != baseline.end() && old->second > 0) {
+      fprintf(stderr, "%-40s %8.1f -> %8.1f ns/frame (%+.1f%%)\n", s.name.c_str(), old->second,
+              r.nsPerFrame, 100.0 * (r.nsPerFrame - old->second) / old->second);
+    }
+  }
+  return 0;
+}
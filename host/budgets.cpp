@@ -0,0 +1,45 @@
+#include <stdio.h>
+
+#include "../functions.h"
+#include "host.h"
+
+// Check that every mode's frame budget (budgetUs in modes.h) reaches the
+// loop profiler.
+//
+//   budgets
+//
+// Enters each mode the way the mode button does and times two loop passes
+// on the virtual clock: one that takes exactly the budget, which must not
+// be reported, and one a microsecond longer, which must be reported as a
+// stall. Exits with 1 if either goes wrong, so `make -C host budgets` fails.
+
+void setup();
+
+// Whether a loop pass taking us is reported as a stall
+static bool stalls(unsigned long us) {
+  uint32_t before = profileStallCount();
+  {
+    PROFILE(PROF_LOOP);
+    hostClockAdvance(us);
+  }
+  return profileStallCount() != before;
+}
+
+int main() {
+  hostSetSerialSink(nullptr);
+  hostSeedRandom(1);
+  setup();
+
+  int failures = 0;
+#define MODE_CHECK(name, enter, exit, update, render, frameMs, budgetUs)                        \
+  {                                                                                              \
+    setMode(name##_MODE);                                                                        \
+    bool within = stalls(budgetUs), over = stalls(budgetUs + 1);                                 \
+    printf("%-8s budget %6lu us: %s\n", #name, (unsigned long)(budgetUs),                        \
+           !within && over ? "overrun reported" : within ? "pass within budget reported" : "overrun missed"); \
+    if (within || !over) failures++;                                                             \
+  }
+  MODES(MODE_CHECK)
+#undef MODE_CHECK
+  return failures ? 1 : 0;
+}
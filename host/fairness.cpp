@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <bitset>
+#include <vector>
+
+#include "../functions.h"
+
+// Exhaustive fairness check of the boss attacks.
+//
+//   fairness [--reaction MS] [-v]
+//
+// For the ring sizes in main() and the configured one, every attack
+// pattern, every boss HP the pattern can appear at, both walking directions
+// and every sub-LED offset the player can have from its LED, searches all the
+// ways the player can press the action button and reports the configurations
+// where no sequence of presses survives the attack. Exits with 1 if there is
+// one, so `make -C host fairness` fails.
+//
+// The search runs tick by tick on the simulation step, the way
+// simulateBossTick() orders things: presses, then the move, then the end of
+// the attack, then the collision check once the HP-scaled warning is over.
+// Every tick moves the player by the same playerTravel() step whichever way
+// it walks (taken with no carry at the start). Debouncing keeps presses at
+// least PRESS_GAP_TICKS apart, so once the player can react the outcome
+// depends on its 8.8 fixed-point position, its direction and the ticks since
+// its last press. For each pattern and HP one pass backwards from the end of
+// the attack finds the positions it can still escape from in each of those
+// states, as bitsets over the positions within reach; each start is then a
+// short walk and a lookup. Zones are placed relative to
+// the player, so by symmetry the player starts within half an LED of LED 0.
+//
+// Timings come from bossTuning; the player cannot react before --reaction
+// ms (default 200) into the warning.
+
+static unsigned long reactionMs = 200;
+static bool verbose = false;
+static unsigned long checked = 0;
+static unsigned long failures = 0;
+
+#define NO_TEXT(name) nullptr, nullptr
+
+// Positions are unwrapped, relative to the middle of the window; an attack
+// is over long before the player could walk out of it
+static const long REACH_LEDS = 32;
+static const long REACH = REACH_LEDS * POS_ONE;
+typedef std::bitset<REACH> Reach;
+
+// A press, its release and the next press each come at least DEBOUNCE_US
+// after the edge before (input.cpp); presses made that far apart can still
+// land in ticks one short of it
+static const int PRESS_GAP_TICKS =
+    2 * DEBOUNCE_US / 1000 / SIM_TICK_MS > 1 ? 2 * DEBOUNCE_US / 1000 / SIM_TICK_MS : 1;
+
+// Escaping positions per walking direction (0: backwards, 1: forwards) and
+// ticks since the last press, capped at PRESS_GAP_TICKS - 1: free to press
+struct Escapes {
+  Reach reach[2][PRESS_GAP_TICKS];
+};
+
+// Attack timings in ticks: the player reacts from reactTick on, collides
+// from warningTick on and is safe from endTick on. steps[k] is how far it
+// moves on tick k.
+struct AttackTicks {
+  int reactTick, warningTick, endTick;
+  std::vector<uint16_t> steps;
+};
+
+// Positions at tick reactTick - 1 from which some press sequence keeps the
+// player out of the zones until the end of the attack. Working backwards, a
+// position escapes if walking on lands on a safe one that does, or, once
+// the last press is PRESS_GAP_TICKS back, turning round does.
+static Escapes escapes(const Reach &safe, const AttackTicks &t) {
+  const int free = PRESS_GAP_TICKS - 1;
+  Escapes next, prev;
+  for (int d = 0; d < 2; d++) {
+    for (int s = 0; s <= free; s++) next.reach[d][s].set();
+  }
+  for (int k = t.endTick - 1; k >= t.reactTick; k--) {
+    uint16_t step = t.steps[k];
+    if (k >= t.warningTick) {
+      for (int d = 0; d < 2; d++) {
+        for (int s = 0; s <= free; s++) next.reach[d][s] &= safe;
+      }
+    }
+    for (int s = 0; s <= free; s++) {
+      int after = s < free ? s + 1 : free;
+      prev.reach[1][s] = next.reach[1][after] >> step;
+      prev.reach[0][s] = next.reach[0][after] << step;
+    }
+    prev.reach[1][free] |= next.reach[0][0] << step;
+    prev.reach[0][free] |= next.reach[1][0] >> step;
+    next = prev;
+  }
+  return next;
+}
+
+// Whether the player starting at offset and walking dir survives: it walks
+// on until it reacts, then, free to press, it needs to be on a position
+// that escapes
+static bool survivable(const Escapes &escape, const Reach &safe, const AttackTicks &t, int dir, int offset) {
+  long pos = REACH / 2 + offset;
+  for (int k = 1; k < t.reactTick; k++) {
+    pos += t.steps[k] * dir;
+    if (k >= t.endTick) return true; // Attack over
+    if (k >= t.warningTick && !safe[pos]) return false;
+  }
+  return escape.reach[dir > 0][PRESS_GAP_TICKS - 1][pos];
+}
+
+template <int N>
+static void checkRing() {
+  typedef Ring<N> R;
+  constexpr AttackPattern patterns[] = ATTACK_PATTERN_TABLE(R, NO_TEXT);
+  const int count = sizeof(patterns) / sizeof(patterns[0]);
+  unsigned long ringFailures = failures;
+
+  for (int p = 0; p < count; p++) {
+    const AttackPattern &pattern = patterns[p];
+    std::bitset<N> safeLeds;
+    safeLeds.set();
+    for (int z = 0; z < pattern.zoneCount; z++) {
+      for (int i = 0; i < pattern.zones[z].width; i++) safeLeds.reset(R::wrap(pattern.zones[z].offset + i));
+    }
+    Reach safe;
+    for (long i = 0; i < REACH; i++) safe[i] = safeLeds[R::led(R::wrapFixed(i - REACH / 2))];
+
+    // Phase 1 runs while HP is above half, phase 2 from half down
+    bool phase2 = pattern.phase == 2;
+    int hpLow = phase2 ? 1 : STRIP2_LEDS / 2 + 1;
+    int hpHigh = phase2 ? STRIP2_LEDS / 2 : STRIP2_LEDS;
+    unsigned long speed = bossTuning.playerSpeed;
+    if (phase2) speed = speed * bossTuning.phase2SpeedPct / 100;
+    uint16_t rate = speed > 0xFFFF ? 0xFFFF : speed;
+    unsigned long endMs = (unsigned long)pattern.warningMs + pattern.hitMs;
+    if ((long)rate * endMs / 1000 + POS_ONE >= REACH / 2) {
+      printf("  ring %d pattern %d: the player can walk out of the search window\n", N, p);
+      failures++;
+      continue;
+    }
+
+    AttackTicks t;
+    t.reactTick = reactionMs > SIM_TICK_MS ? (reactionMs + SIM_TICK_MS - 1) / SIM_TICK_MS : 1;
+    t.endTick = endMs / SIM_TICK_MS + 1;
+    t.steps.resize(t.endTick + 1);
+    uint16_t carry = 0;
+    PlayerStride stride = tickStride(rate);
+    for (int k = 1; k <= t.endTick; k++) t.steps[k] = playerTravel(stride, carry);
+
+    for (int hp = hpLow; hp <= hpHigh; hp++) {
+      unsigned int warningMs = tunedWarningMs(pattern.warningMs, hp);
+      t.warningTick = (warningMs + SIM_TICK_MS - 1) / SIM_TICK_MS;
+      static Escapes escape;
+      escape = escapes(safe, t);
+      for (int dir = -1; dir <= 1; dir += 2) {
+        for (int offset = -POS_ONE / 2; offset < POS_ONE / 2; offset++) {
+          checked++;
+          if (survivable(escape, safe, t, dir, offset)) continue;
+          failures++;
+          if (verbose || failures - ringFailures <= 5) {
+            printf("  ring %d pattern %d HP %d walking %+d from %+d/%d LED: "
+                   "no escape (warning %u ms, %.2f LEDs/s)\n",
+                   N, p, hp, dir, offset, POS_ONE, warningMs, rate / (double)SPEED_ONE);
+          }
+        }
+      }
+    }
+  }
+  printf("ring %3d: %s", N, failures == ringFailures ? "every attack survivable\n" : "");
+  if (failures != ringFailures) printf("%lu unsurvivable configurations\n", failures - ringFailures);
+}
+
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--reaction") && i + 1 < argc) {
+      reactionMs = strtoul(argv[++i], NULL, 10);
+    } else if (!strcmp(argv[i], "-v")) {
+      verbose = true;
+    } else {
+      fprintf(stderr, "usage: fairness [--reaction MS] [-v]\n");
+      return 2;
+    }
+  }
+
+  checkRing<12>();
+  checkRing<16>();
+  checkRing<24>();
+  checkRing<32>();
+  checkRing<60>();
+  checkRing<144>();
+  checkRing<300>();
+  if (Arena::size != 12 && Arena::size != 16 && Arena::size != 24 && Arena::size != 32 &&
+      Arena::size != 60 && Arena::size != 144 && Arena::size != 300) {
+    checkRing<Arena::size>(); // The configured ring
+  }
+
+  printf("%lu configurations checked, %lu unsurvivable\n", checked, failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,105 @@
+#include "frame_decoder.h"
+
+#include "../framecap.h"
+#include "../telemetry.h"
+
+FrameDecoder::FrameDecoder()
+    : need(0), skip(0), inRecord(false), synced{ false, false }, lastMs{ 0, 0 }, lastStrip(0),
+      keyCount(0), deltaCount(0), byteCount(0), errorCount(0) {}
+
+static bool readVarint(const uint8_t *&p, const uint8_t *end, uint32_t &v) {
+  v = 0;
+  for (int shift = 0; p < end && shift < 32; shift += 7) {
+    uint8_t b = *p++;
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+bool FrameDecoder::feed(uint8_t c) {
+  // Telemetry record: id and length, then timestamp, payload and checksum
+  if (skip) {
+    buf.push_back(c);
+    if (buf.size() == 2) skip = 2 + 4 + c + 1;
+    if (buf.size() == skip) {
+      buf.clear();
+      skip = 0;
+    }
+    return false;
+  }
+
+  if (!inRecord) {
+    if (c == FRAME_SYNC) {
+      inRecord = true;
+      need = 3; // kind and length come next
+    } else if (c == TELEMETRY_SYNC) {
+      skip = 2; // Until its length is known
+    }
+    return false;
+  }
+
+  buf.push_back(c);
+  if (buf.size() == 3) need = 3 + (buf[1] | buf[2] << 8) + 1;
+  if (buf.size() < need) return false;
+
+  uint8_t checksum = 0;
+  for (size_t i = 0; i + 1 < buf.size(); i++) checksum ^= buf[i];
+  if (checksum != buf.back()) synced[0] = synced[1] = false; // Whichever strip it was
+  bool ok = checksum == buf.back() && apply();
+  if (ok) byteCount += 1 + buf.size();
+  else errorCount++;
+  buf.clear();
+  inRecord = false;
+  return ok;
+}
+
+// Apply a complete record to its strip
+bool FrameDecoder::apply() {
+  int s = buf[0] & FRAME_KIND_STRIP2;
+  const uint8_t *p = buf.data() + 3;
+  const uint8_t *end = buf.data() + buf.size() - 1;
+  std::vector<uint8_t> &px = pixels[s];
+  uint32_t v, n;
+
+  if (buf[0] & FRAME_KIND_KEY) {
+    if (end - p < 4) return false;
+    unsigned long ms = p[0] | p[1] << 8 | (unsigned long)p[2] << 16 | (unsigned long)p[3] << 24;
+    p += 4;
+    if (!readVarint(p, end, n)) return false;
+    std::vector<uint8_t> frame;
+    while (p < end) {
+      if (!readVarint(p, end, v) || end - p < 3 || frame.size() / 3 + v > n) return false;
+      for (uint32_t i = 0; i < v; i++) frame.insert(frame.end(), p, p + 3);
+      p += 3;
+    }
+    if (frame.size() != n * 3) return false;
+    px.swap(frame);
+    lastMs[s] = ms;
+    synced[s] = true;
+    keyCount++;
+  } else {
+    if (!synced[s]) return false;
+    synced[s] = false; // Until this delta has applied cleanly
+    if (!readVarint(p, end, v)) return false;
+    unsigned long ms = lastMs[s] + v;
+    std::vector<uint8_t> frame = px;
+    size_t pos = 0;
+    while (p < end) {
+      uint32_t skipped;
+      if (!readVarint(p, end, skipped) || !readVarint(p, end, n) || end - p < 3) return false;
+      pos += skipped;
+      if ((pos + n) * 3 > frame.size()) return false;
+      for (uint32_t i = 0; i < n; i++, pos++) {
+        for (int c = 0; c < 3; c++) frame[pos * 3 + c] ^= p[c];
+      }
+      p += 3;
+    }
+    px.swap(frame);
+    lastMs[s] = ms;
+    synced[s] = true;
+    deltaCount++;
+  }
+  lastStrip = s;
+  return true;
+}
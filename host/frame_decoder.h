@@ -0,0 +1,40 @@
+#ifndef FRAME_DECODER_H
+#define FRAME_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Streaming decoder for the frame capture records of framecap.h. Feed it
+// bytes as they arrive; telemetry records in the same stream are skipped.
+// After feed() returns true, strip(frameStrip()) holds the frame that was
+// pushed at frameMillis().
+class FrameDecoder {
+public:
+  FrameDecoder();
+  bool feed(uint8_t c);
+
+  const std::vector<uint8_t> &strip(int i) const { return pixels[i]; } // GRB bytes
+  int frameStrip() const { return lastStrip; }
+  unsigned long frameMillis() const { return lastMs[lastStrip]; }
+
+  unsigned long keyframes() const { return keyCount; }
+  unsigned long deltas() const { return deltaCount; }
+  unsigned long bytes() const { return byteCount; }
+  unsigned long errors() const { return errorCount; } // Corrupt records and deltas with nothing to apply to
+
+private:
+  bool apply();
+
+  std::vector<uint8_t> buf; // kind, length, body and checksum (sync is not kept)
+  size_t need;
+  size_t skip;              // Bytes left of a telemetry record
+  bool inRecord;
+  std::vector<uint8_t> pixels[2];
+  bool synced[2];
+  unsigned long lastMs[2];
+  int lastStrip;
+  unsigned long keyCount, deltaCount, byteCount, errorCount;
+};
+
+#endif
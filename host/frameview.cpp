@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+
+#include "frame_decoder.h"
+
+// Play a frame capture (ledsim --frames, or the 'f' serial command on a
+// board) back in a terminal, one row of LEDs per strip.
+//
+//   frameview [--speed X] [--quiet] [file]
+//
+// Frames are shown at their recorded times, --speed X times faster; --speed
+// 0 shows them as fast as they decode. Reads stdin without a file, so a live
+// run can be watched with `ledsim --realtime --frames - | frameview`.
+// --quiet skips the drawing and only prints the stream summary.
+
+static void drawStrip(const std::vector<uint8_t> &px) {
+  fputs("\x1b[K ", stdout);
+  for (size_t i = 0; i + 2 < px.size(); i += 3) {
+    uint8_t g = px[i], r = px[i + 1], b = px[i + 2];
+    if (r | g | b) printf("\x1b[38;2;%d;%d;%dm\xe2\x97\x8f", r, g, b); // ●
+    else fputs("\x1b[38;2;60;60;60m\xc2\xb7", stdout);               // ·
+  }
+  fputs("\x1b[0m\n", stdout);
+}
+
+static void draw(const FrameDecoder &decoder, bool redraw) {
+  if (redraw) fputs("\x1b[3A", stdout);
+  printf("\x1b[K[%8.3f]\n", decoder.frameMillis() / 1000.0);
+  drawStrip(decoder.strip(0));
+  drawStrip(decoder.strip(1));
+  fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+  double speed = 1;
+  bool quiet = false;
+  const char *path = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--speed") && i + 1 < argc) {
+      speed = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "--quiet")) {
+      quiet = true;
+    } else if (argv[i][0] == '-' && argv[i][1]) {
+      fprintf(stderr, "usage: frameview [--speed X] [--quiet] [file]\n");
+      return 2;
+    } else if (strcmp(argv[i], "-")) {
+      path = argv[i];
+    }
+  }
+
+  FILE *in = path ? fopen(path, "rb") : stdin;
+  if (!in) {
+    perror(path);
+    return 1;
+  }
+
+  FrameDecoder decoder;
+  auto wallStart = std::chrono::steady_clock::now();
+  unsigned long firstMs = 0;
+  bool drawn = false;
+  int c;
+  while ((c = fgetc(in)) != EOF) {
+    if (!decoder.feed((uint8_t)c) || quiet) continue;
+    if (!drawn) firstMs = decoder.frameMillis();
+    if (speed > 0) {
+      auto due = wallStart + std::chrono::duration<double, std::milli>((decoder.frameMillis() - firstMs) / speed);
+      std::this_thread::sleep_until(due);
+    }
+    draw(decoder, drawn);
+    drawn = true;
+  }
+
+  unsigned long frames = decoder.keyframes() + decoder.deltas();
+  fprintf(stderr, "%lu frames (%lu keyframes, %lu deltas), %lu bytes, %.1f bytes/frame",
+          frames, decoder.keyframes(), decoder.deltas(), decoder.bytes(),
+          frames ? (double)decoder.bytes() / frames : 0.0);
+  if (decoder.errors()) fprintf(stderr, ", %lu records skipped", decoder.errors());
+  fputc('\n', stderr);
+  return 0;
+}
@@ -0,0 +1,384 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../settings.h"
+#include "../input.h"
+#include "../timekeeping.h"
+#include "host.h"
+
+// Host implementation of the hardware abstraction layer
+
+// Virtual clock
+static uint64_t clockMicros = 0;
+static bool realtime = false;
+
+void hostClockReset() {
+  clockMicros = 0;
+}
+
+uint64_t hostClockMicros() {
+  return clockMicros;
+}
+
+void hostClockAdvance(uint64_t us) {
+  clockMicros += us;
+  if (realtime) {
+    struct timespec ts;
+    ts.tv_sec = us / 1000000;
+    ts.tv_nsec = (us % 1000000) * 1000;
+    nanosleep(&ts, NULL);
+  }
+}
+
+void hostSetRealtime(bool enabled) {
+  realtime = enabled;
+}
+
+unsigned long halMillis() {
+  return (unsigned long)(clockMicros / 1000);
+}
+
+unsigned long halMicros() {
+  return (unsigned long)clockMicros;
+}
+
+void halDelay(unsigned long ms) {
+  hostClockAdvance((uint64_t)ms * 1000);
+}
+
+// Input
+static bool buttonDown[32];
+
+// Stands in for the pin-change interrupt
+void hostSetButton(uint8_t pin, bool down) {
+  if (pin >= 32 || buttonDown[pin] == down) return;
+  buttonDown[pin] = down;
+  inputEdge(pin, down, halMicros());
+}
+
+void halInitInput() {
+  for (int i = 0; i < 32; i++) buttonDown[i] = false;
+}
+
+bool halButtonDown(uint8_t pin) {
+  return pin < 32 && buttonDown[pin];
+}
+
+// Entropy: the board reads pin noise, the host hands out the driver's seed
+// so runs are reproducible
+static uint32_t entropySeed = 1;
+
+void hostSeedRandom(uint32_t seed) {
+  entropySeed = seed;
+}
+
+uint32_t halEntropy() {
+  return entropySeed;
+}
+
+// Time source
+static bool rtcEnabled = false;
+static const char *rtcPath = NULL;
+static long rtcDriftPpm = 0;
+static uint32_t rtcBaseSeconds = 0;   // RTC time at rtcBaseMicros
+static uint64_t rtcBaseMicros = 0;
+
+void hostRtcEnable(const char *path, long driftPpm) {
+  rtcEnabled = true;
+  rtcPath = path;
+  rtcDriftPpm = driftPpm;
+}
+
+static uint32_t rtcSeconds() {
+  uint64_t elapsed = clockMicros - rtcBaseMicros;
+  return rtcBaseSeconds + (uint32_t)(elapsed * (1000000 + rtcDriftPpm) / 1000000000000ULL);
+}
+
+static void rtcSave(uint32_t seconds) {
+  if (!rtcPath) return;
+  FILE *f = fopen(rtcPath, "w");
+  if (!f) return;
+  fprintf(f, "%lu\n", (unsigned long)seconds);
+  fclose(f);
+}
+
+static bool rtcBegin() {
+  if (!rtcEnabled) return false;
+  rtcBaseMicros = clockMicros;
+  if (rtcPath) {
+    FILE *f = fopen(rtcPath, "r");
+    unsigned long seconds;
+    if (f && fscanf(f, "%lu", &seconds) == 1) rtcBaseSeconds = seconds;
+    if (f) fclose(f);
+  }
+  return true;
+}
+
+static bool rtcRead(uint32_t &seconds) {
+  seconds = rtcSeconds();
+  rtcSave(seconds);
+  return true;
+}
+
+static bool rtcWrite(uint32_t seconds) {
+  rtcBaseSeconds = seconds;
+  rtcBaseMicros = clockMicros;
+  rtcSave(seconds);
+  return true;
+}
+
+static const TimeSource hostTimeSource = { rtcBegin, rtcRead, rtcWrite };
+
+const TimeSource *halTimeSource() {
+  return &hostTimeSource;
+}
+
+// EEPROM
+static const uint16_t EEPROM_SIZE = 1024;
+static const uint64_t EEPROM_WRITE_MICROS = 3400;
+static uint8_t eeprom[EEPROM_SIZE];
+static bool eepromErased = false;
+static FILE *eepromFile = NULL;
+static uint64_t eepromReadyAt = 0;
+static uint32_t eepromWrites[EEPROM_SIZE];
+
+static void eepromErase() {
+  if (eepromErased) return;
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  eepromErased = true;
+}
+
+void hostEepromEnable(const char *path) {
+  eepromErase();
+  eepromFile = fopen(path, "r+b");
+  if (!eepromFile) eepromFile = fopen(path, "w+b");
+  if (!eepromFile) {
+    perror(path);
+    return;
+  }
+  size_t n = fread(eeprom, 1, EEPROM_SIZE, eepromFile);
+  if (n < EEPROM_SIZE) {
+    // New or short file: extend it with erased bytes
+    fseek(eepromFile, 0, SEEK_SET);
+    fwrite(eeprom, 1, EEPROM_SIZE, eepromFile);
+    fflush(eepromFile);
+  }
+}
+
+uint32_t hostEepromWrites(uint32_t *maxPerCell) {
+  uint32_t total = 0, most = 0;
+  for (uint16_t i = 0; i < EEPROM_SIZE; i++) {
+    total += eepromWrites[i];
+    if (eepromWrites[i] > most) most = eepromWrites[i];
+  }
+  if (maxPerCell) *maxPerCell = most;
+  return total;
+}
+
+uint8_t halEepromRead(uint16_t addr) {
+  eepromErase();
+  return addr < EEPROM_SIZE ? eeprom[addr] : 0xFF;
+}
+
+bool halEepromReady() {
+  return clockMicros >= eepromReadyAt;
+}
+
+void halEepromWrite(uint16_t addr, uint8_t value) {
+  eepromErase();
+  if (addr >= EEPROM_SIZE || eeprom[addr] == value) return;
+  if (clockMicros < eepromReadyAt) hostClockAdvance(eepromReadyAt - clockMicros); // Busy, like EEPROM.update()
+  eepromReadyAt = clockMicros + EEPROM_WRITE_MICROS;
+  eeprom[addr] = value;
+  eepromWrites[addr]++;
+  if (eepromFile) {
+    fseek(eepromFile, addr, SEEK_SET);
+    fputc(value, eepromFile);
+    fflush(eepromFile);
+  }
+}
+
+// Serial
+HostSerial Serial;
+
+static const int SERIAL_TX_BUFFER = 64;
+static HostSerialSink serialSink = NULL;
+static uint64_t serialByteMicros = 1042; // 9600 baud, 10 bits per byte
+static uint64_t txDrainedUntil = 0;      // Time the last queued byte leaves the wire
+static uint32_t serialBytes = 0;
+static uint64_t serialStall = 0;
+
+void hostSetSerialSink(HostSerialSink sink) {
+  serialSink = sink;
+}
+
+uint32_t hostSerialBytes() {
+  return serialBytes;
+}
+
+uint64_t hostSerialStallMicros() {
+  return serialStall;
+}
+
+void HostSerial::begin(unsigned long baud) {
+  serialByteMicros = 10000000ULL / baud;
+  txDrainedUntil = clockMicros;
+}
+
+// Bytes still waiting in the TX buffer
+static uint64_t txQueued() {
+  if (txDrainedUntil <= clockMicros) return 0;
+  return (txDrainedUntil - clockMicros + serialByteMicros - 1) / serialByteMicros;
+}
+
+int HostSerial::availableForWrite() {
+  uint64_t queued = txQueued();
+  return queued >= SERIAL_TX_BUFFER - 1 ? 0 : (int)(SERIAL_TX_BUFFER - 1 - queued);
+}
+
+size_t HostSerial::write(uint8_t c) {
+  // Block like HardwareSerial when the TX buffer is full
+  if (txDrainedUntil < clockMicros) txDrainedUntil = clockMicros;
+  uint64_t queued = txQueued();
+  if (queued >= SERIAL_TX_BUFFER) {
+    uint64_t wait = txDrainedUntil - (SERIAL_TX_BUFFER - 1) * serialByteMicros - clockMicros;
+    serialStall += wait;
+    hostClockAdvance(wait);
+  }
+  txDrainedUntil += serialByteMicros;
+  serialBytes++;
+  if (serialSink) serialSink(c);
+  return 1;
+}
+
+// Serial input
+static const int SERIAL_RX_QUEUE = 256;
+static uint64_t rxAt[SERIAL_RX_QUEUE];
+static uint8_t rxBytes[SERIAL_RX_QUEUE];
+static int rxHead = 0, rxTail = 0;
+
+void hostSerialInput(uint64_t atMicros, const char *text) {
+  for (; *text; text++) {
+    int next = (rxHead + 1) % SERIAL_RX_QUEUE;
+    if (next == rxTail) return; // Full, like an overrun on the board
+    rxAt[rxHead] = atMicros;
+    rxBytes[rxHead] = *text;
+    rxHead = next;
+  }
+}
+
+int HostSerial::available() {
+  int n = 0;
+  for (int i = rxTail; i != rxHead && rxAt[i] <= clockMicros; i = (i + 1) % SERIAL_RX_QUEUE) n++;
+  return n;
+}
+
+int HostSerial::read() {
+  if (rxTail == rxHead || rxAt[rxTail] > clockMicros) return -1;
+  uint8_t c = rxBytes[rxTail];
+  rxTail = (rxTail + 1) % SERIAL_RX_QUEUE;
+  return c;
+}
+
+size_t HostSerial::write(const char *str) {
+  size_t n = 0;
+  while (*str) n += write((uint8_t)*str++);
+  return n;
+}
+
+size_t HostSerial::print(const char *str) { return write(str); }
+size_t HostSerial::print(const __FlashStringHelper *str) { return write((const char *)str); }
+size_t HostSerial::print(char c) { return write((uint8_t)c); }
+size_t HostSerial::print(int n) { return print((long)n); }
+size_t HostSerial::print(unsigned int n) { return print((unsigned long)n); }
+
+size_t HostSerial::print(long n) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), "%ld", n);
+  return write(buf);
+}
+
+size_t HostSerial::print(unsigned long n) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), "%lu", n);
+  return write(buf);
+}
+
+size_t HostSerial::print(double n, int digits) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return write(buf);
+}
+
+size_t HostSerial::println() {
+  return write("\r\n");
+}
+
+// Strips
+static HostShowHook showHook = NULL;
+static uint32_t showCount = 0;
+static uint64_t pixelWrites = 0;
+
+void hostSetShowHook(HostShowHook hook) {
+  showHook = hook;
+}
+
+uint32_t hostShowCount() {
+  return showCount;
+}
+
+uint64_t hostPixelWrites() {
+  return pixelWrites;
+}
+
+void halCountPixelWrites(uint32_t count) {
+  pixelWrites += count;
+}
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t n, int16_t p, uint16_t)
+    : numLEDs(n), pin(p), pixels((uint8_t *)calloc(n, 3)) {}
+
+Adafruit_NeoPixel::~Adafruit_NeoPixel() {
+  free(pixels);
+}
+
+void Adafruit_NeoPixel::begin() {}
+
+void Adafruit_NeoPixel::show() {
+  // WS2812: 30 us per LED on the wire plus the 50 us latch
+  hostClockAdvance(30ULL * numLEDs + 50);
+  showCount++;
+  if (showHook) showHook(*this);
+}
+
+void Adafruit_NeoPixel::clear() {
+  pixelWrites += numLEDs;
+  memset(pixels, 0, numLEDs * 3);
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint32_t c) {
+  setPixelColor(n, (uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c);
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) {
+  pixelWrites++;
+  if (n >= numLEDs) return;
+  uint8_t *p = &pixels[n * 3];
+  p[0] = g;
+  p[1] = r;
+  p[2] = b;
+}
+
+void Adafruit_NeoPixel::fill(uint32_t c, uint16_t first, uint16_t count) {
+  if (first >= numLEDs) return;
+  uint16_t end = (count == 0 || first + count > numLEDs) ? numLEDs : first + count;
+  for (uint16_t i = first; i < end; i++) setPixelColor(i, c);
+}
+
+uint32_t Adafruit_NeoPixel::getPixelColor(uint16_t n) const {
+  if (n >= numLEDs) return 0;
+  const uint8_t *p = &pixels[n * 3];
+  return ((uint32_t)p[1] << 16) | ((uint32_t)p[0] << 8) | p[2];
+}
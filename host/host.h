@@ -0,0 +1,50 @@
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdint.h>
+
+class Adafruit_NeoPixel;
+
+// Host-side control over the simulated board. The mode code only sees hal.h;
+// drivers and tools use these calls to steer time, buttons and the RNG.
+
+// Virtual clock (microseconds since boot). halDelay() and strip pushes advance
+// it instantly unless realtime pacing is enabled.
+void hostClockReset();
+uint64_t hostClockMicros();
+void hostClockAdvance(uint64_t us);
+void hostSetRealtime(bool enabled);
+
+// Buttons
+void hostSetButton(uint8_t pin, bool down);
+
+// Session seed returned by halEntropy()
+void hostSeedRandom(uint32_t seed);
+
+// Serial output (simulated 64-byte TX buffer draining at the configured baud).
+// Every byte written is also handed to the sink, if any.
+typedef void (*HostSerialSink)(uint8_t c);
+void hostSetSerialSink(HostSerialSink sink);
+uint32_t hostSerialBytes();
+uint64_t hostSerialStallMicros();
+// Serial input: text becomes readable at atMicros (calls must come in time order)
+void hostSerialInput(uint64_t atMicros, const char *text);
+
+// Virtual RTC: runs off the virtual clock, faster by driftPpm (so the board's
+// millis() looks that much slow), and keeps its time in path between runs if
+// path is given. Without this call the sketch sees no RTC.
+void hostRtcEnable(const char *path, long driftPpm);
+
+// EEPROM: 1 KB like the Uno's, erased (all 0xFF) at start. With a path it
+// is loaded from and written through to that file, so state survives
+// between runs like a power cycle.
+void hostEepromEnable(const char *path);
+uint32_t hostEepromWrites(uint32_t *maxPerCell); // Byte writes so far, and the most to one cell
+
+// Strip pushes
+typedef void (*HostShowHook)(const Adafruit_NeoPixel &strip);
+void hostSetShowHook(HostShowHook hook);
+uint32_t hostShowCount();
+uint64_t hostPixelWrites(); // setPixelColor() calls; fill(), clear() and the pixel kernels count per LED
+
+#endif
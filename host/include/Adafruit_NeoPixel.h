@@ -0,0 +1,39 @@
+#ifndef HOST_ADAFRUIT_NEOPIXEL_H
+#define HOST_ADAFRUIT_NEOPIXEL_H
+
+// Adafruit_NeoPixel-compatible strip for the host build. Pixels live in a
+// plain GRB buffer; show() charges the WS2812 wire time to the virtual clock
+// and notifies the host so tools can inspect what was pushed.
+
+#include "Arduino.h"
+
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel {
+public:
+  Adafruit_NeoPixel(uint16_t n, int16_t pin, uint16_t type);
+  ~Adafruit_NeoPixel();
+
+  void begin();
+  void show();
+  void clear();
+  void setPixelColor(uint16_t n, uint32_t c);
+  void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b);
+  void fill(uint32_t c = 0, uint16_t first = 0, uint16_t count = 0);
+  uint32_t getPixelColor(uint16_t n) const;
+  uint16_t numPixels() const { return numLEDs; }
+  int16_t getPin() const { return pin; }
+  uint8_t *getPixels() const { return pixels; }
+
+  static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+  }
+
+private:
+  uint16_t numLEDs;
+  int16_t pin;
+  uint8_t *pixels;
+};
+
+#endif
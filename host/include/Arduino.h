@@ -0,0 +1,58 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Minimal Arduino core surface for the host build. Only what the mode code
+// uses directly is provided; clock, input and RNG go through hal.h.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef uint8_t byte;
+
+// Flash-resident data is ordinary memory on the host
+#define PROGMEM
+#define PGM_P const char *
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr) (*(const void *const *)(addr))
+
+class __FlashStringHelper;
+#define F(str) (reinterpret_cast<const __FlashStringHelper *>(str))
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// Print-compatible serial port backed by a simulated UART
+class HostSerial {
+public:
+  void begin(unsigned long baud);
+  int availableForWrite();
+  int available();
+  int read();
+  size_t write(uint8_t c);
+  size_t write(const char *str);
+
+  size_t print(const char *str);
+  size_t print(const __FlashStringHelper *str);
+  size_t print(char c);
+  size_t print(int n);
+  size_t print(unsigned int n);
+  size_t print(long n);
+  size_t print(unsigned long n);
+  size_t print(double n, int digits = 2);
+
+  size_t println();
+  template <typename T> size_t println(T value) {
+    size_t n = print(value);
+    return n + println();
+  }
+};
+
+extern HostSerial Serial;
+
+#endif
@@ -0,0 +1,246 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+
+#include "../functions.h"
+#include "host.h"
+#include "tlm_decoder.h"
+#include "session.h"
+
+// Native Linux runner: executes the sketch against the host HAL with a
+// virtual clock so whole sessions run far faster than real time.
+
+static TelemetryDecoder decoder(stdout);
+
+static void decodeSerial(uint8_t c) {
+  decoder.feed(c);
+}
+
+static void rawSerial(uint8_t c) {
+  putchar(c);
+}
+
+// Frame capture file
+static FILE *framesFile = NULL;
+static unsigned long framesCaptured = 0;
+static unsigned long framesBytes = 0;
+
+static bool beginFrameRecord(uint16_t bytes) {
+  framesCaptured++;
+  framesBytes += bytes;
+  return true;
+}
+
+static void putFrameByte(uint8_t b) {
+  fputc(b, framesFile);
+}
+
+static const FrameSink fileFrameSink = { beginFrameRecord, putFrameByte };
+
+static long setTime = -1;
+
+static void applySetTime() {
+  if (setTime >= 0) timeSet(timeNow() - timeNow() % 86400 + setTime);
+}
+
+struct ScriptedPress {
+  unsigned long atMs;
+  uint8_t pin;
+};
+
+static void usage() {
+  fprintf(stderr,
+          "usage: ledsim [options]\n"
+          "  --mode clock|reaction|boss  start in this mode (default clock)\n"
+          "  --seconds N                 simulated run time (default 60)\n"
+          "  --seed N                    RNG seed (default 1)\n"
+          "  --press BTN@MS              press mode/action at MS, repeatable\n"
+          "  --hold MS                   how long presses are held (default 60)\n"
+          "  --loop-us N                 CPU cost charged per loop() (default 200)\n"
+          "  --realtime                  pace the virtual clock to the wall clock\n"
+          "  --quiet                     do not echo serial output\n"
+          "  --rtc FILE                  fit a virtual RTC that keeps its time in FILE\n"
+          "  --rtc-drift PPM             how much faster the RTC runs than millis()\n"
+          "  --time HH:MM:SS             set the clock after boot\n"
+          "  --eeprom FILE               keep the EEPROM in FILE, so saved state carries over\n"
+          "  --raw                       echo raw telemetry instead of decoded text\n"
+          "  --debug                     include debug-level telemetry\n"
+          "  --random-presses N          add N presses at random times (from --seed)\n"
+          "  --record FILE               save the session with frame hashes for replay\n"
+          "  --frames FILE               capture every frame pushed for frameview (- for stdout)\n"
+          "  --serial MS:TEXT            send TEXT to the serial port at MS, repeatable\n"
+          "  --profile                   dump the loop profile one second before the end\n");
+}
+
+int main(int argc, char **argv) {
+  Mode startMode = CLOCK_MODE;
+  unsigned long runMs = 60000;
+  unsigned long holdMs = 60;
+  uint64_t loopMicros = 200;
+  uint32_t seed = 1;
+  std::vector<ScriptedPress> presses;
+  HostSerialSink sink = decodeSerial;
+  bool debug = false;
+  const char *rtcPath = NULL;
+  long rtcDrift = 0;
+  bool rtc = false;
+  int randomPresses = 0;
+  const char *recordPath = NULL;
+  const char *eepromPath = NULL;
+  const char *framesPath = NULL;
+  std::vector<std::pair<unsigned long, std::string>> serialInput;
+  bool profile = false;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+    if (!strcmp(arg, "--mode") && val) {
+      if (!strcmp(val, "clock")) startMode = CLOCK_MODE;
+      else if (!strcmp(val, "reaction")) startMode = REACTION_MODE;
+      else if (!strcmp(val, "boss")) startMode = BOSS_MODE;
+      else { usage(); return 2; }
+      i++;
+    } else if (!strcmp(arg, "--seconds") && val) {
+      runMs = (unsigned long)(atof(val) * 1000);
+      i++;
+    } else if (!strcmp(arg, "--seed") && val) {
+      seed = (uint32_t)strtoul(val, NULL, 0);
+      i++;
+    } else if (!strcmp(arg, "--press") && val) {
+      const char *at = strchr(val, '@');
+      if (!at) { usage(); return 2; }
+      ScriptedPress p;
+      p.pin = !strncmp(val, "mode", at - val) ? BTN_MODE : BTN_ACTION;
+      p.atMs = strtoul(at + 1, NULL, 10);
+      presses.push_back(p);
+      i++;
+    } else if (!strcmp(arg, "--hold") && val) {
+      holdMs = strtoul(val, NULL, 10);
+      i++;
+    } else if (!strcmp(arg, "--loop-us") && val) {
+      loopMicros = strtoull(val, NULL, 10);
+      i++;
+    } else if (!strcmp(arg, "--rtc") && val) {
+      rtc = true;
+      rtcPath = val;
+      i++;
+    } else if (!strcmp(arg, "--rtc-drift") && val) {
+      rtc = true;
+      rtcDrift = strtol(val, NULL, 10);
+      i++;
+    } else if (!strcmp(arg, "--time") && val) {
+      int h = 0, m = 0, s = 0;
+      if (sscanf(val, "%d:%d:%d", &h, &m, &s) < 2) { usage(); return 2; }
+      setTime = (h * 60L + m) * 60 + s;
+      i++;
+    } else if (!strcmp(arg, "--random-presses") && val) {
+      randomPresses = atoi(val);
+      i++;
+    } else if (!strcmp(arg, "--eeprom") && val) {
+      eepromPath = val;
+      i++;
+    } else if (!strcmp(arg, "--frames") && val) {
+      framesPath = val;
+      i++;
+    } else if (!strcmp(arg, "--record") && val) {
+      recordPath = val;
+      i++;
+    } else if (!strcmp(arg, "--serial") && val) {
+      const char *colon = strchr(val, ':');
+      if (!colon) { usage(); return 2; }
+      serialInput.push_back({ strtoul(val, NULL, 10), colon + 1 });
+      i++;
+    } else if (!strcmp(arg, "--profile")) {
+      profile = true;
+    } else if (!strcmp(arg, "--realtime")) {
+      hostSetRealtime(true);
+    } else if (!strcmp(arg, "--quiet")) {
+      sink = NULL;
+    } else if (!strcmp(arg, "--raw")) {
+      sink = rawSerial;
+    } else if (!strcmp(arg, "--debug")) {
+      debug = true;
+    } else {
+      usage();
+      return 2;
+    }
+  }
+
+  if (eepromPath && recordPath) {
+    fprintf(stderr, "ledsim: --record cannot be combined with --eeprom, replays boot from an erased EEPROM\n");
+    return 2;
+  }
+
+  // Random presses: mostly the action button, now and then a mode change
+  std::mt19937 gen(seed);
+  for (int i = 0; i < randomPresses; i++) {
+    ScriptedPress p;
+    p.pin = gen() % 10 == 0 ? BTN_MODE : BTN_ACTION;
+    p.atMs = gen() % runMs;
+    presses.push_back(p);
+  }
+
+  Session session;
+  session.seed = seed;
+  session.startMode = startMode;
+  session.loopMicros = loopMicros;
+  session.endMicros = (uint64_t)runMs * 1000;
+  for (const ScriptedPress &p : presses) {
+    session.edges.push_back({ (uint64_t)p.atMs * 1000, p.pin, true });
+    session.edges.push_back({ (uint64_t)(p.atMs + holdMs) * 1000, p.pin, false });
+  }
+  std::stable_sort(session.edges.begin(), session.edges.end(),
+                   [](const SessionEdge &a, const SessionEdge &b) { return a.atMicros < b.atMicros; });
+
+  if (profile) serialInput.push_back({ runMs > 1000 ? runMs - 1000 : 0, "p" });
+  std::stable_sort(serialInput.begin(), serialInput.end(),
+                   [](const std::pair<unsigned long, std::string> &a,
+                      const std::pair<unsigned long, std::string> &b) { return a.first < b.first; });
+  for (const auto &input : serialInput) hostSerialInput((uint64_t)input.first * 1000, input.second.c_str());
+
+  hostSetSerialSink(sink);
+  if (debug) setTelemetryLevel(TLM_DEBUG);
+  if (rtc) hostRtcEnable(rtcPath, rtcDrift);
+  if (eepromPath) hostEepromEnable(eepromPath);
+  if (framesPath) {
+    framesFile = strcmp(framesPath, "-") ? fopen(framesPath, "wb") : stdout;
+    if (!framesFile) {
+      perror(framesPath);
+      return 1;
+    }
+    if (framesFile == stdout) hostSetSerialSink(NULL); // stdout carries the frames
+    setFrameSink(&fileFrameSink);
+  }
+  auto wallStart = std::chrono::steady_clock::now();
+
+  unsigned long iterations = runSession(session, recordPath ? &session.frames : NULL, applySetTime);
+
+  double wallMs = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - wallStart).count();
+  fflush(stdout);
+  fprintf(stderr,
+          "\nsimulated %.3f s in %.3f ms wall (%.0fx), %lu loops, %u shows, "
+          "%u serial bytes, %.1f ms serial stall, %u telemetry records dropped\n",
+          halMillis() / 1000.0, wallMs, wallMs > 0 ? halMillis() / wallMs : 0.0,
+          iterations, hostShowCount(), hostSerialBytes(),
+          hostSerialStallMicros() / 1000.0, droppedTelemetry());
+  uint32_t maxPerCell;
+  uint32_t eepromWrites = hostEepromWrites(&maxPerCell);
+  if (framesPath) {
+    fflush(framesFile);
+    fprintf(stderr, "%lu frames captured, %.1f bytes/frame\n", framesCaptured,
+            framesCaptured ? (double)framesBytes / framesCaptured : 0.0);
+  }
+  if (eepromWrites) fprintf(stderr, "%u EEPROM byte writes, at most %u to one cell\n", eepromWrites, maxPerCell);
+
+  if (recordPath && !saveSession(recordPath, session)) {
+    perror(recordPath);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "host.h"
+#include "session.h"
+
+// Replays recorded sessions at full speed and checks that every frame pushed
+// to the strips matches the recording.
+//
+//   replay [-j N] [-v] session...
+//
+// Each session runs in its own forked process (the sketch keeps its state in
+// globals), up to N at a time. Exits non-zero if any session diverges.
+
+static void usage() {
+  fprintf(stderr, "usage: replay [-j N] [-v] session...\n");
+}
+
+// Child side: run one session and compare frames; the exit status is the verdict
+static int replayOne(const char *path, bool verbose) {
+  Session session;
+  std::string error;
+  if (!loadSession(path, session, error)) {
+    fprintf(stderr, "%s\n", error.c_str());
+    return 2;
+  }
+
+  std::vector<SessionFrame> frames;
+  runSession(session, &frames);
+
+  size_t n = std::min(frames.size(), session.frames.size());
+  for (size_t i = 0; i < n; i++) {
+    const SessionFrame &want = session.frames[i];
+    const SessionFrame &got = frames[i];
+    if (want.atMicros != got.atMicros || want.strip != got.strip || want.hash != got.hash) {
+      fprintf(stderr,
+              "%s: frame %zu differs: recorded strip %u at %llu us hash %08x, "
+              "replayed strip %u at %llu us hash %08x\n",
+              path, i, want.strip, (unsigned long long)want.atMicros, want.hash, got.strip,
+              (unsigned long long)got.atMicros, got.hash);
+      return 1;
+    }
+  }
+  if (frames.size() != session.frames.size()) {
+    fprintf(stderr, "%s: recorded %zu frames, replayed %zu\n", path, session.frames.size(),
+            frames.size());
+    return 1;
+  }
+  if (verbose) fprintf(stderr, "%s: %zu frames match\n", path, frames.size());
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  bool verbose = false;
+  std::vector<const char *> paths;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-j") && i + 1 < argc) jobs = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-v")) verbose = true;
+    else if (argv[i][0] == '-') { usage(); return 2; }
+    else paths.push_back(argv[i]);
+  }
+  if (paths.empty()) {
+    usage();
+    return 2;
+  }
+  if (jobs < 1) jobs = 1;
+
+  hostSetSerialSink(nullptr);
+  fflush(NULL);
+  auto wallStart = std::chrono::steady_clock::now();
+
+  std::map<pid_t, const char *> running;
+  size_t next = 0, passed = 0, failed = 0;
+  while (next < paths.size() || !running.empty()) {
+    while (next < paths.size() && (int)running.size() < jobs) {
+      pid_t pid = fork();
+      if (pid == 0) _exit(replayOne(paths[next], verbose));
+      if (pid < 0) {
+        perror("fork");
+        return 2;
+      }
+      running[pid] = paths[next++];
+    }
+
+    int status;
+    pid_t pid = wait(&status);
+    if (pid < 0) break;
+    running.erase(pid);
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) passed++;
+    else failed++;
+  }
+
+  double wallMs = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - wallStart).count();
+  fprintf(stderr, "%zu sessions: %zu match, %zu diverged (%.1f ms wall)\n", paths.size(), passed,
+          failed, wallMs);
+  return failed ? 1 : 0;
+}
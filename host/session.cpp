@@ -0,0 +1,94 @@
+#include "session.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+
+#include "../functions.h"
+#include "host.h"
+
+void setup();
+void loop();
+
+bool loadSession(const char *path, Session &session, std::string &error) {
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    error = std::string(path) + ": " + strerror(errno);
+    return false;
+  }
+
+  session = Session();
+  char line[128];
+  int lineNo = 0;
+  while (fgets(line, sizeof(line), f)) {
+    lineNo++;
+    unsigned long long a, b;
+    unsigned int c;
+    if (line[0] == '#' || line[0] == '\n') continue;
+    if (sscanf(line, "seed %llu", &a) == 1) session.seed = (uint32_t)a;
+    else if (sscanf(line, "mode %llu", &a) == 1) session.startMode = (int)a;
+    else if (sscanf(line, "loop-us %llu", &a) == 1) session.loopMicros = a;
+    else if (sscanf(line, "end-us %llu", &a) == 1) session.endMicros = a;
+    else if (sscanf(line, "edge %llu %llu %u", &a, &b, &c) == 3)
+      session.edges.push_back({ a, (uint8_t)b, c != 0 });
+    else if (sscanf(line, "frame %llu %llu %x", &a, &b, &c) == 3)
+      session.frames.push_back({ a, (uint8_t)b, c });
+    else {
+      error = std::string(path) + ":" + std::to_string(lineNo) + ": bad line";
+      fclose(f);
+      return false;
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+bool saveSession(const char *path, const Session &session) {
+  FILE *f = fopen(path, "w");
+  if (!f) return false;
+  fprintf(f, "seed %lu\nmode %d\nloop-us %llu\nend-us %llu\n", (unsigned long)session.seed,
+          session.startMode, (unsigned long long)session.loopMicros,
+          (unsigned long long)session.endMicros);
+  for (const SessionEdge &e : session.edges)
+    fprintf(f, "edge %llu %u %d\n", (unsigned long long)e.atMicros, e.pin, e.down ? 1 : 0);
+  for (const SessionFrame &fr : session.frames)
+    fprintf(f, "frame %llu %u %08x\n", (unsigned long long)fr.atMicros, fr.strip, fr.hash);
+  return fclose(f) == 0;
+}
+
+static std::vector<SessionFrame> *capturedFrames = nullptr;
+
+// FNV-1a over the GRB bytes of every pushed frame
+static void captureFrame(const Adafruit_NeoPixel &strip) {
+  const uint8_t *p = strip.getPixels();
+  uint32_t hash = 2166136261UL;
+  for (int i = 0; i < strip.numPixels() * 3; i++) hash = (hash ^ p[i]) * 16777619UL;
+  uint8_t id = strip.getPin() == STRIP1_PIN ? 1 : 2;
+  capturedFrames->push_back({ hostClockMicros(), id, hash });
+}
+
+unsigned long runSession(const Session &session, std::vector<SessionFrame> *frames,
+                void (*afterSetup)()) {
+  hostClockReset();
+  hostSeedRandom(session.seed);
+  capturedFrames = frames;
+  hostSetShowHook(frames ? captureFrame : nullptr);
+
+  setup();
+  if (session.startMode != currentMode) setMode((Mode)session.startMode);
+  if (afterSetup) afterSetup();
+
+  size_t next = 0;
+  unsigned long iterations = 0;
+  while (hostClockMicros() < session.endMicros) {
+    while (next < session.edges.size() && session.edges[next].atMicros <= hostClockMicros()) {
+      hostSetButton(session.edges[next].pin, session.edges[next].down);
+      next++;
+    }
+    loop();
+    hostClockAdvance(session.loopMicros);
+    iterations++;
+  }
+  hostSetShowHook(nullptr);
+  return iterations;
+}
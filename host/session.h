@@ -0,0 +1,50 @@
+#ifndef HOST_SESSION_H
+#define HOST_SESSION_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Recorded game sessions
+//
+// A session is everything needed to reproduce a run of the sketch on the
+// host: the seed behind every RNG stream, the start mode, the loop cost and
+// the timestamped button edges. Recording also keeps a hash of every frame
+// pushed to the strips so a replay can be checked frame by frame.
+//
+// Text format, one item per line:
+//   seed N / mode N / loop-us N / end-us N
+//   edge <us> <pin> <0|1>
+//   frame <us> <strip> <hash hex>
+
+struct SessionEdge {
+  uint64_t atMicros;
+  uint8_t pin;
+  bool down;
+};
+
+struct SessionFrame {
+  uint64_t atMicros;
+  uint8_t strip;
+  uint32_t hash;
+};
+
+struct Session {
+  uint32_t seed = 1;
+  int startMode = 0;
+  uint64_t loopMicros = 200;
+  uint64_t endMicros = 60000000;
+  std::vector<SessionEdge> edges;   // In time order
+  std::vector<SessionFrame> frames;
+};
+
+bool loadSession(const char *path, Session &session, std::string &error);
+bool saveSession(const char *path, const Session &session);
+
+// Run the sketch through a session, collecting the frames it pushes, and
+// return the number of loop() passes. The sketch's globals are not reset, so
+// run at most one session per process.
+unsigned long runSession(const Session &session, std::vector<SessionFrame> *frames,
+                void (*afterSetup)() = nullptr);
+
+#endif
@@ -0,0 +1,85 @@
+#!/bin/sh
+# Static SRAM used by each module of the sketch.
+#
+#   sram_report.sh [OBJECT|ARCHIVE|DIR ...]      (default: build/sketch)
+#
+# Sums the data objects (.data and .bss, plus .rodata on AVR where it is
+# copied to RAM; .progmem stays in flash) of every object file, then works
+# out the headroom left on the board after the NeoPixel pixel buffers
+# (3 bytes per LED on the heap) and a stack reserve. The ring size is read
+# from the framebuffer's front buffers.
+#
+# For real numbers point it at the Arduino build, e.g.
+#   OBJDUMP=avr-objdump host/sram_report.sh /tmp/arduino-build/sketch /tmp/arduino-build/core/core.a
+# Host objects use the host ABI (8-byte longs and pointers), so their totals
+# only show relative sizes.
+#
+# Environment: OBJDUMP (objdump), RAM (2048), STACK (256), TOP (8 largest
+# symbols listed).
+
+OBJDUMP=${OBJDUMP:-objdump}
+RAM=${RAM:-2048}
+STACK=${STACK:-256}
+TOP=${TOP:-8}
+
+[ $# -eq 0 ] && set -- "$(dirname "$0")/build/sketch"
+
+files=""
+for arg in "$@"; do
+  if [ -d "$arg" ]; then
+    files="$files $(find "$arg" -maxdepth 1 \( -name '*.o' -o -name '*.a' \) | sort)"
+  else
+    files="$files $arg"
+  fi
+done
+[ -n "$files" ] || { echo "no object files found" >&2; exit 1; }
+
+# shellcheck disable=SC2086
+$OBJDUMP -t $files | awk -v ram="$RAM" -v stack="$STACK" -v top="$TOP" '
+  function hex(s,    v, i) {
+    v = 0
+    for (i = 1; i <= length(s); i++) v = v * 16 + index("0123456789abcdef", tolower(substr(s, i, 1))) - 1
+    return v
+  }
+  /file format/ {
+    module = $1; sub(/:$/, "", module); sub(/.*\//, "", module); sub(/\.(cpp|ino|c)\.o$|\.o$/, "", module)
+    avr = ($NF == "elf32-avr")
+    next
+  }
+  # addr flags... section size name: the section is the field before the size
+  NF >= 5 && $(NF - 2) ~ /^\./ {
+    section = $(NF - 2); size = hex($(NF - 1)); name = $NF
+    if ($0 !~ / O /) next
+    if (section ~ /^\.progmem/ || section ~ /^\.data\.rel\.ro/) next
+    if (!(section ~ /^\.(data|bss)/ || (avr && section ~ /^\.rodata/))) next
+    if (size == 0) next
+    used[module] += size; total += size
+    sym[module "  " name] = size
+    if (name ~ /front1$/) ring1 = size / 3
+    if (name ~ /front2$/) ring2 = size / 3
+  }
+  END {
+    printf "%-24s %6s\n", "module", "bytes"
+    n = 0
+    for (m in used) order[++n] = m
+    for (i = 1; i <= n; i++)
+      for (j = i + 1; j <= n; j++)
+        if (used[order[j]] > used[order[i]]) { t = order[i]; order[i] = order[j]; order[j] = t }
+    for (i = 1; i <= n; i++) printf "%-24s %6d\n", order[i], used[order[i]]
+    printf "%-24s %6d\n\n", "static total", total
+
+    printf "largest:\n"
+    k = 0
+    for (s in sym) list[++k] = s
+    for (i = 1; i <= k && i <= top; i++) {
+      for (j = i + 1; j <= k; j++) if (sym[list[j]] > sym[list[i]]) { t = list[i]; list[i] = list[j]; list[j] = t }
+      printf "  %-40s %6d\n", list[i], sym[list[i]]
+    }
+
+    pixels = 3 * (ring1 + ring2)
+    free = ram - total - pixels - stack
+    printf "\nrings %d + %d LEDs: %d bytes of NeoPixel buffers on the heap\n", ring1, ring2, pixels
+    printf "free after a %d-byte stack reserve: %d bytes of %d\n", stack, free, ram
+    if (free > 0) printf "room for about %d more play-ring LEDs (6 bytes each)\n", free / 6
+    else printf "over budget by %d bytes\n", -free
+  }'
@@ -0,0 +1,121 @@
+#include "tlm_decoder.h"
+
+#include "../telemetry.h"
+#include "../framecap.h"
+#include "../attacks.h"
+#include "../profiler_sections.h"
+
+#define TELEMETRY_EVENT_FORMAT(name, level, format) format,
+static const char *const eventFormats[] = { TELEMETRY_EVENTS(TELEMETRY_EVENT_FORMAT) };
+#undef TELEMETRY_EVENT_FORMAT
+
+#define PROFILE_SECTION_LABEL(name, label) label,
+static const char *const profileSections[] = { PROFILE_SECTIONS(PROFILE_SECTION_LABEL) };
+#undef PROFILE_SECTION_LABEL
+
+TelemetryDecoder::TelemetryDecoder(FILE *o, bool ts)
+    : out(o), timestamps(ts), have(0), need(0), frameHeader(0), frameLength(0), skip(0), recordCount(0),
+      errorCount(0) {}
+
+// buf holds id, length, timestamp, payload and checksum (sync is not kept)
+void TelemetryDecoder::feed(uint8_t c) {
+  // Frame capture records (framecap.h) are skipped: kind and 16-bit length,
+  // then as many body bytes and the checksum
+  if (frameHeader) {
+    if (frameHeader == 2) frameLength = c;
+    if (frameHeader == 3) skip = (frameLength | c << 8) + 1;
+    frameHeader = frameHeader == 3 ? 0 : frameHeader + 1;
+    return;
+  }
+  if (skip) {
+    skip--;
+    return;
+  }
+
+  if (have == 0 && need == 0) {
+    if (c == TELEMETRY_SYNC) need = 2; // id and length come next
+    if (c == FRAME_SYNC) frameHeader = 1;
+    return;
+  }
+
+  buf[have++] = c;
+  if (have == 2) {
+    uint8_t length = buf[1];
+    if (buf[0] >= EV_COUNT || length > 2 * TELEMETRY_MAX_VALUES || (length & 1)) {
+      errorCount++;
+      have = need = 0;
+      return;
+    }
+    need = 2 + 4 + length + 1;
+  }
+  if (have < need) return;
+
+  uint8_t checksum = 0;
+  for (int i = 0; i < have - 1; i++) checksum ^= buf[i];
+  if (checksum == buf[have - 1]) {
+    emit();
+    recordCount++;
+  } else {
+    errorCount++;
+  }
+  have = need = 0;
+}
+
+void TelemetryDecoder::emit() {
+  uint8_t id = buf[0];
+  int count = buf[1] / 2;
+  unsigned long ms = buf[2] | (buf[3] << 8) | ((unsigned long)buf[4] << 16) |
+                     ((unsigned long)buf[5] << 24);
+  int16_t values[TELEMETRY_MAX_VALUES];
+  for (int i = 0; i < count; i++) values[i] = (int16_t)(buf[6 + 2 * i] | (buf[7 + 2 * i] << 8));
+
+  if (timestamps) fprintf(out, "[%8.3f] ", ms / 1000.0);
+
+  int next = 0;
+  for (const char *f = eventFormats[id]; *f; f++) {
+    if (*f != '%' || !f[1]) {
+      fputc(*f, out);
+      continue;
+    }
+    char token = *++f;
+    int value = next < count ? values[next] : 0;
+    switch (token) {
+      case 'd':
+        fprintf(out, "%d", value);
+        next++;
+        break;
+      case 'u':
+        fprintf(out, "%u", (uint16_t)value);
+        next++;
+        break;
+      case 'p':
+        if (value >= 0 && value < PROF_COUNT) fputs(profileSections[value], out);
+        next++;
+        break;
+      case 'l':
+        fprintf(out, "%lu", (unsigned long)(uint16_t)value |
+                                ((unsigned long)(uint16_t)(next + 1 < count ? values[next + 1] : 0) << 16));
+        next += 2;
+        break;
+      case 'i':
+        fprintf(out, "%ld", (long)(int32_t)((uint32_t)(uint16_t)value |
+                                            ((uint32_t)(uint16_t)(next + 1 < count ? values[next + 1] : 0) << 16)));
+        next += 2;
+        break;
+      case 'a':
+      case 'h':
+        if (value >= 0 && value < attackPatternCount) {
+          const AttackPattern &pattern = attackPatterns[value];
+          fputs(token == 'a' ? pattern.announce : pattern.hitMessage, out);
+        }
+        next++;
+        break;
+      case 'z':
+        for (; next < count; next++) fprintf(out, " %d", values[next]);
+        break;
+      default:
+        fputc(token, out);
+    }
+  }
+  fputc('\n', out);
+}
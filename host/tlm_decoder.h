@@ -0,0 +1,32 @@
+#ifndef TLM_DECODER_H
+#define TLM_DECODER_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Streaming decoder for the binary telemetry records of telemetry.h. Feed it
+// bytes as they arrive; every complete record is printed as the line the
+// firmware used to print, optionally prefixed with its timestamp.
+class TelemetryDecoder {
+public:
+  explicit TelemetryDecoder(FILE *out, bool timestamps = false);
+  void feed(uint8_t c);
+  unsigned long records() const { return recordCount; }
+  unsigned long errors() const { return errorCount; }
+
+private:
+  void emit();
+
+  FILE *out;
+  bool timestamps;
+  uint8_t buf[64];
+  int have;
+  int need;
+  int frameHeader; // Bytes of a frame record header seen, 0 outside one
+  uint16_t frameLength;
+  long skip;       // Bytes left of a frame record
+  unsigned long recordCount;
+  unsigned long errorCount;
+};
+
+#endif
@@ -0,0 +1,30 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "tlm_decoder.h"
+
+// Decode a binary telemetry stream (serial capture or ledsim --raw) to text.
+//
+//   tlmdecode [-t] [file]     -t prefixes each line with its timestamp
+
+int main(int argc, char **argv) {
+  bool timestamps = false;
+  const char *path = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-t")) timestamps = true;
+    else path = argv[i];
+  }
+
+  FILE *in = path ? fopen(path, "rb") : stdin;
+  if (!in) {
+    perror(path);
+    return 1;
+  }
+
+  TelemetryDecoder decoder(stdout, timestamps);
+  int c;
+  while ((c = fgetc(in)) != EOF) decoder.feed((uint8_t)c);
+
+  if (decoder.errors()) fprintf(stderr, "%lu corrupt records skipped\n", decoder.errors());
+  return 0;
+}
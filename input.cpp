@@ -0,0 +1,126 @@
+#include "settings.h"
+#include "input.h"
+#include "telemetry.h"
+
+// Raw edge ring: inputEdge() only writes edgeHead, pollInput() only writes
+// edgeTail. Single-byte indices are atomic on AVR, so no locking is needed.
+static ButtonEvent edges[INPUT_QUEUE_SIZE];
+static volatile uint8_t edgeHead = 0;
+static volatile uint8_t edgeTail = 0;
+static volatile unsigned int edgesDropped = 0;
+
+// Debounce state and debounced presses for one button
+struct ButtonState {
+  uint8_t pin;
+  bool down;
+  unsigned long lastEdge;
+  ButtonEvent presses[PRESS_QUEUE_SIZE];
+  uint8_t pressHead;
+  uint8_t pressCount;
+};
+
+static ButtonState buttons[] = {
+  { BTN_MODE, false, 0, {}, 0, 0 },
+  { BTN_ACTION, false, 0, {}, 0, 0 },
+};
+static const uint8_t BUTTON_COUNT = sizeof(buttons) / sizeof(buttons[0]);
+
+static ButtonState *findButton(uint8_t pin) {
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    if (buttons[i].pin == pin) return &buttons[i];
+  }
+  return NULL;
+}
+
+// Record a pin change (called from the pin-change interrupt)
+void inputEdge(uint8_t pin, bool down, unsigned long micros) {
+  uint8_t head = edgeHead;
+  uint8_t next = (head + 1) & (INPUT_QUEUE_SIZE - 1);
+  if (next == edgeTail) {
+    edgesDropped++;
+    return;
+  }
+  edges[head].pin = pin;
+  edges[head].down = down;
+  edges[head].micros = micros;
+  edgeHead = next;
+}
+
+// Queue a debounced press, dropping the oldest if nobody consumed it
+static void pushPress(ButtonState &button, const ButtonEvent &event) {
+  if (button.pressCount == PRESS_QUEUE_SIZE) {
+    button.pressHead = (button.pressHead + 1) % PRESS_QUEUE_SIZE;
+    button.pressCount--;
+  }
+  button.presses[(button.pressHead + button.pressCount) % PRESS_QUEUE_SIZE] = event;
+  button.pressCount++;
+}
+
+// Take a debounced edge. Only these are logged: fed back through
+// inputEdge() they pass the debounce again and give the same presses, which
+// is all a session replay needs, while a bouncy contact cannot flood the
+// telemetry ring.
+static void acceptEdge(ButtonState &button, const ButtonEvent &event) {
+  int16_t edgeLog[] = { event.pin, event.down, (int16_t)event.micros, (int16_t)(event.micros >> 16) };
+  logEventValues(EV_INPUT_EDGE, edgeLog, 4);
+
+  button.down = event.down;
+  button.lastEdge = event.micros;
+  if (event.down) pushPress(button, event);
+}
+
+// Drain raw edges into debounced presses
+void pollInput() {
+  while (edgeTail != edgeHead) {
+    ButtonEvent event = edges[edgeTail];
+    edgeTail = (edgeTail + 1) & (INPUT_QUEUE_SIZE - 1);
+
+    ButtonState *button = findButton(event.pin);
+    if (!button || event.down == button->down) continue;
+    if (event.micros - button->lastEdge < DEBOUNCE_US) continue; // Contact bounce
+    acceptEdge(*button, event);
+  }
+
+  // An edge swallowed as bounce can leave a button out of step with its pin
+  // (e.g. a tap shorter than the debounce window); resync once it settles.
+  unsigned long now = halMicros();
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
+    ButtonState &button = buttons[i];
+    if (now - button.lastEdge < DEBOUNCE_US) continue;
+    bool down = halButtonDown(button.pin);
+    if (down == button.down) continue;
+
+    ButtonEvent event = { button.pin, down, now };
+    acceptEdge(button, event);
+  }
+}
+
+// Take the oldest pending press of a button
+bool takePress(uint8_t pin, ButtonEvent &press) {
+  ButtonState *button = findButton(pin);
+  if (!button || button->pressCount == 0) return false;
+
+  press = button->presses[button->pressHead];
+  button->pressHead = (button->pressHead + 1) % PRESS_QUEUE_SIZE;
+  button->pressCount--;
+  return true;
+}
+
+// Take the oldest pending press only if it was made by `micros`, for code
+// that replays input in time steps
+bool takePressBefore(uint8_t pin, unsigned long micros, ButtonEvent &press) {
+  ButtonState *button = findButton(pin);
+  if (!button || button->pressCount == 0) return false;
+  if ((long)(button->presses[button->pressHead].micros - micros) > 0) return false;
+  return takePress(pin, press);
+}
+
+// Forget presses nobody is going to consume (e.g. on mode change)
+void flushPresses(uint8_t pin) {
+  ButtonState *button = findButton(pin);
+  if (button) button->pressCount = 0;
+}
+
+unsigned int droppedInputEvents() {
+  return edgesDropped;
+}
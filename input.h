@@ -0,0 +1,34 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "hal.h"
+
+// Interrupt-driven button input
+//
+// The HAL reports every pin change from its interrupt handler through
+// inputEdge(), which timestamps it and pushes it into a single-producer /
+// single-consumer ring. pollInput() drains the ring from the main loop,
+// debounces on the edge timestamps and queues presses per button, so a press
+// is never lost however long a frame takes.
+
+#define INPUT_QUEUE_SIZE 16   // Raw edges, power of two
+#define PRESS_QUEUE_SIZE 4    // Debounced presses per button
+#define DEBOUNCE_US 20000UL   // Edges closer than this to the last one are bounce
+
+struct ButtonEvent {
+  uint8_t pin;
+  bool down;
+  unsigned long micros;
+};
+
+// Producer side, interrupt context only
+void inputEdge(uint8_t pin, bool down, unsigned long micros);
+
+// Consumer side, main loop only
+void pollInput();
+bool takePress(uint8_t pin, ButtonEvent &press);
+bool takePressBefore(uint8_t pin, unsigned long micros, ButtonEvent &press);
+void flushPresses(uint8_t pin);
+unsigned int droppedInputEvents();
+
+#endif
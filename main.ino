@@ -1,5 +1,6 @@
 #include "settings.h"
 #include "functions.h"
+#include "scheduler.h"
 
 // NeoPixel strip objects
 Adafruit_NeoPixel strip1(STRIP1_LEDS, STRIP1_PIN, NEO_GRB + NEO_KHZ800);
@@ -8,40 +9,135 @@ Adafruit_NeoPixel strip2(STRIP2_LEDS, STRIP2_PIN, NEO_GRB + NEO_KHZ800);
 // Current game mode
 Mode currentMode = CLOCK_MODE;
 
+// State of the active mode
+ModeState modeState;
+
+// Frame period per mode in ms (0 = every loop pass), see modes.h; the boss
+// fight simulates in its own ticks, so this is only its redraw rate
+#define MODE_FRAME_MS(name, enter, exit, update, render, frameMs, budgetUs) frameMs,
+const unsigned long modeFrameMs[] = { MODES(MODE_FRAME_MS) };
+#undef MODE_FRAME_MS
+
+// Loop pass budget per mode in us, see modes.h
+#define MODE_BUDGET_US(name, enter, exit, update, render, frameMs, budgetUs) budgetUs,
+const unsigned long modeBudgetUs[] = { MODES(MODE_BUDGET_US) };
+#undef MODE_BUDGET_US
+static int frameTask = -1;
+
 void setup() {
   initializeHardware();
   initializeGameState();
-  Serial.println("=== Boss Fight Game Started ===");
+  frameTask = scheduleEvery(runFrame, modeFrameMs[currentMode]);
+  scheduleEvery(timeUpdate, TIME_UPDATE_MS);
+  logEvent(EV_STARTED);
 }
 
 void loop() {
-  handleModeSwitch();
-  runCurrentMode();
+  PROFILE(PROF_LOOP);
+  {
+    PROFILE(PROF_INPUT);
+    pollInput();
+    handleSerialCommands();
+  }
+  {
+    PROFILE(PROF_MODE_SWITCH);
+    handleModeSwitch();
+  }
+  runScheduler();
+  {
+    PROFILE(PROF_PERSIST);
+    if (persistDue()) {
+      captureModeState();
+      persistSave();
+    }
+    persistService();
+  }
+  {
+    PROFILE(PROF_SERIAL);
+    profileService();
+    flushTelemetry();
+  }
+}
+
+// Serial commands: 'p' dumps the loop profile, 'r' resets it, 's' dumps the
+// reaction statistics of the running session, 'f' toggles streaming every
+// frame pushed (see framecap.h)
+void handleSerialCommands() {
+  while (Serial.available() > 0) {
+    switch (Serial.read()) {
+      case 'p': profileDump(); break;
+      case 'r': profileReset(); break;
+      case 's': if (currentMode == REACTION_MODE) reactionStatsDump(); break;
+      case 'f': setFrameSink(frameSink() ? NULL : &serialFrameSink); break;
+    }
+  }
 }
 
 // Handle mode switching with button press
 void handleModeSwitch() {
-  if (!digitalRead(BTN_MODE)) {
-    currentMode = (Mode)((currentMode + 1) % 3);
-    clearStrips(); // Clear strips on mode change
-    delay(300); // Debounce
-    switch (currentMode) {
-      case CLOCK_MODE: Serial.println(">> Mode: CLOCK"); break;
-      case REACTION_MODE: Serial.println(">> Mode: REACTION"); break;
-      case BOSS_MODE: 
-        Serial.println(">> Mode: BOSS"); 
-        resetBossFight();
-        break;
-    }
+  ButtonEvent press;
+  while (takePress(BTN_MODE, press)) {
+    setMode((Mode)((currentMode + 1) % MODE_COUNT));
   }
 }
 
-// Run the current game mode
+// Copy what the running mode would lose on a reset into the persisted record
+void captureModeState() {
+  if (currentMode == BOSS_MODE) suspendBossFight(persisted.boss);
+  persisted.mode = currentMode;
+  if (!timeHasSource()) persisted.clockSeconds = timeNow(); // An RTC keeps its own time
+}
+
+// Enter a game mode
+void setMode(Mode mode) {
+  switch (currentMode) {
+#define MODE_EXIT(name, enter, exit, update, render, frameMs, budgetUs) \
+    case name##_MODE: exit(); break;
+    MODES(MODE_EXIT)
+#undef MODE_EXIT
+    default: break;
+  }
+
+  currentMode = mode;
+  persisted.mode = mode;
+  persistTouch();
+  stopEffect();
+  flushPresses(BTN_ACTION); // Presses meant for the previous mode
+  clearStrips(); // Clear strips on mode change
+  setTaskPeriod(frameTask, modeFrameMs[currentMode]);
+  profileSetBudget(modeBudgetUs[currentMode]);
+  switch (currentMode) {
+#define MODE_ENTER(name, enter, exit, update, render, frameMs, budgetUs) \
+    case name##_MODE:                                                    \
+      logEvent(EV_MODE_##name);                                          \
+      enter();                                                           \
+      break;
+    MODES(MODE_ENTER)
+#undef MODE_ENTER
+    default: break;
+  }
+}
+
+// Frame task: run the current mode unless an effect owns the strips
+void runFrame() {
+  if (!effectRunning()) {
+    runCurrentMode();
+  }
+}
+
+// Run the current game mode: update it, and draw it if it changed and
+// did not hand the strips to an effect
 void runCurrentMode() {
   switch (currentMode) {
-    case CLOCK_MODE: showClock(); break;
-    case REACTION_MODE: playReactionGame(); break;
-    case BOSS_MODE: playBossFight(); break;
+#define MODE_RUN(name, enter, exit, update, render, frameMs, budgetUs) \
+    case name##_MODE: {                                                \
+      PROFILE(PROF_##name);                                            \
+      if (update() && !effectRunning()) render();                      \
+      break;                                                           \
+    }
+    MODES(MODE_RUN)
+#undef MODE_RUN
+    default: break;
   }
 }
 
@@ -50,15 +146,22 @@ void initializeHardware() {
   Serial.begin(9600);
   strip1.begin();
   strip2.begin();
-  strip1.show();
-  strip2.show();
+  canvasFlush();
 
-  pinMode(BTN_MODE, INPUT_PULLUP);
-  pinMode(BTN_ACTION, INPUT_PULLUP);
-  randomSeed(analogRead(A0));
+  halInitInput();
+  rngBegin(halEntropy());
+  timeBegin(halTimeSource());
 }
 
-// Initialize game state
+// Initialize game state (the modes share one state arena, see state.h),
+// coming back up in the mode and state that were saved last
 void initializeGameState() {
-  resetBossFight();
+  persistBegin();
+  if (!timeHasSource() && persisted.clockSeconds) timeSet(persisted.clockSeconds);
+  if (persisted.mode != CLOCK_MODE && persisted.mode < MODE_COUNT) {
+    setMode((Mode)persisted.mode);
+  } else {
+    resetClock();
+    profileSetBudget(modeBudgetUs[CLOCK_MODE]);
+  }
 }
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef MODES_H
+#define MODES_H
+
+// Game mode registry
+//
+// X(name, enter, exit, update, render, frameMs, budgetUs): one line per mode,
+// in the order the mode button cycles through them. The Mode enum, the frame
+// periods and budgets and the dispatch in setMode() and runCurrentMode() are
+// generated
+// from this list as switches of direct calls, so adding a mode is adding a
+// line (plus its EV_MODE_<name> event and PROF_<name> profiler section).
+//
+//   enter    initializes the mode's member of ModeState (see state.h)
+//   exit     runs before the next mode's enter reuses that memory
+//   update   advances the mode; returns whether render has anything new
+//   render   composes the frame; skipped while an effect owns the strips
+//   frameMs  frame period in ms, 0 for every loop pass
+//   budgetUs longest a loop pass may take in the mode; setMode() hands it to
+//            the profiler, which reports a longer pass as a stall. The
+//            reaction game gets half a step at top speed, so the yellow LED
+//            is drawn on every LED it passes; the boss fight a tick, past
+//            which its simulation falls behind.
+#define MODES(X)                                                                                     \
+  X(CLOCK, resetClock, noModeHook, updateClock, drawClock, 50, 10000)                                \
+  X(REACTION, resetReaction, endReaction, updateReaction, drawReaction, 0, 5000)                     \
+  X(BOSS, enterBossFight, exitBossFight, updateBossFight, drawBossFightDisplay, 2 * SIM_TICK_MS,     \
+    SIM_TICK_MS * 1000UL)
+
+#define MODE_ENUM(name, enter, exit, update, render, frameMs, budgetUs) name##_MODE,
+enum Mode { MODES(MODE_ENUM) MODE_COUNT };
+#undef MODE_ENUM
+
+// Enter or exit step of a mode that has none
+inline void noModeHook() {}
+
+#endif
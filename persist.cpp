@@ -0,0 +1,118 @@
+#include <string.h>
+
+#include "persist.h"
+#include "telemetry.h"
+
+#define SLOT_SIZE (5 + sizeof(PersistRecord))
+#define SLOT_COUNT (PERSIST_SIZE / SLOT_SIZE)
+static_assert(SLOT_COUNT >= 2, "the slot ring needs room for two records");
+
+PersistRecord persisted;
+
+static int16_t currentSlot = -1; // Newest valid slot, -1 if none
+static uint16_t currentSeq = 0;
+static bool touched = false;
+static unsigned long lastSave = 0;
+
+// Slot image being written, a byte at a time
+static uint8_t staged[SLOT_SIZE];
+static uint16_t stagedAddr = 0;
+static uint8_t stagedNext = SLOT_SIZE; // SLOT_SIZE: nothing left to write
+
+// CRC-16/CCITT, one byte
+static uint16_t crc16(uint16_t crc, uint8_t b) {
+  crc ^= (uint16_t)b << 8;
+  for (uint8_t i = 0; i < 8; i++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  return crc;
+}
+
+static uint16_t slotAddr(uint16_t slot) {
+  return PERSIST_BASE + slot * SLOT_SIZE;
+}
+
+static uint16_t readWord(uint16_t addr) {
+  return halEepromRead(addr) | (uint16_t)halEepromRead(addr + 1) << 8;
+}
+
+// Whether a slot holds a valid record; its sequence number goes to seq
+static bool readSlot(uint16_t slot, uint16_t &seq) {
+  uint16_t addr = slotAddr(slot);
+  if (halEepromRead(addr) != PERSIST_VERSION) return false;
+  uint16_t crc = 0xFFFF;
+  for (uint16_t i = 0; i < SLOT_SIZE - 2; i++) crc = crc16(crc, halEepromRead(addr + i));
+  if (crc != readWord(addr + SLOT_SIZE - 2)) return false;
+  seq = readWord(addr + 1);
+  return true;
+}
+
+void persistBegin() {
+  memset(&persisted, 0, sizeof(persisted));
+  currentSlot = -1;
+  for (uint16_t slot = 0; slot < SLOT_COUNT; slot++) {
+    uint16_t seq;
+    if (!readSlot(slot, seq)) continue;
+    if (currentSlot >= 0 && (int16_t)(seq - currentSeq) <= 0) continue; // Wrap-safe newer
+    currentSlot = slot;
+    currentSeq = seq;
+  }
+
+  lastSave = halMillis();
+  if (currentSlot < 0) {
+    logEvent(EV_PERSIST_EMPTY);
+    return;
+  }
+  uint8_t *p = (uint8_t *)&persisted;
+  for (uint16_t i = 0; i < sizeof(persisted); i++) p[i] = halEepromRead(slotAddr(currentSlot) + 3 + i);
+  logEvent(EV_PERSIST_LOADED, currentSlot, SLOT_COUNT, currentSeq);
+}
+
+void persistTouch() {
+  touched = true;
+}
+
+bool persistWriting() {
+  return stagedNext < SLOT_SIZE;
+}
+
+bool persistDue() {
+  return touched && !persistWriting() && halMillis() - lastSave >= PERSIST_MIN_INTERVAL_MS;
+}
+
+void persistSave() {
+  if (persistWriting()) return; // Stays touched, saved once this one is done
+  touched = false;
+  lastSave = halMillis();
+
+  // Unchanged since the newest slot: no write, no wear
+  if (currentSlot >= 0) {
+    const uint8_t *p = (const uint8_t *)&persisted;
+    uint16_t i = 0;
+    while (i < sizeof(persisted) && halEepromRead(slotAddr(currentSlot) + 3 + i) == p[i]) i++;
+    if (i == sizeof(persisted)) return;
+  }
+
+  uint16_t slot = currentSlot < 0 ? 0 : (currentSlot + 1) % SLOT_COUNT;
+  uint16_t seq = currentSeq + 1;
+  staged[0] = PERSIST_VERSION;
+  staged[1] = seq;
+  staged[2] = seq >> 8;
+  memcpy(staged + 3, &persisted, sizeof(persisted));
+  uint16_t crc = 0xFFFF;
+  for (uint16_t i = 0; i < SLOT_SIZE - 2; i++) crc = crc16(crc, staged[i]);
+  staged[SLOT_SIZE - 2] = crc;
+  staged[SLOT_SIZE - 1] = crc >> 8;
+
+  stagedAddr = slotAddr(slot);
+  stagedNext = 0;
+  currentSlot = slot;
+  currentSeq = seq;
+}
+
+void persistService() {
+  if (!persistWriting()) return;
+  while (stagedNext < SLOT_SIZE && halEepromReady()) {
+    halEepromWrite(stagedAddr + stagedNext, staged[stagedNext]);
+    stagedNext++;
+  }
+  if (!persistWriting()) logEvent(EV_PERSIST_SAVED, currentSlot, currentSeq);
+}
@@ -0,0 +1,67 @@
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include "hal.h"
+
+// Persistent game state
+//
+// One small record (persisted) holds the high scores, the reaction
+// difficulty, the mode to come back up in and a snapshot of a suspended boss
+// fight. The EEPROM is a ring of slots, each a full copy of the record:
+//
+//   version (1), sequence (2, LE), record, CRC-16/CCITT (2, LE) of the rest
+//
+// Every save goes to the slot after the newest one, which spreads the wear
+// over the whole ring. At boot the valid slot (CRC and version match) with
+// the highest sequence number wins; a torn write just fails its CRC and the
+// previous slot stays current. A record whose layout changes needs a new
+// PERSIST_VERSION, which makes older slots read as empty.
+//
+// Saving is lazy and never blocks: persistTouch() marks the record changed,
+// and persistService() stages a copy and writes it a byte per loop pass
+// while the EEPROM is ready, at most once every PERSIST_MIN_INTERVAL_MS.
+
+#define PERSIST_VERSION 2
+#define PERSIST_BASE 0                 // First EEPROM byte of the slot ring
+#define PERSIST_SIZE 1024              // Bytes in the ring (the Uno's whole EEPROM)
+#define PERSIST_MIN_INTERVAL_MS 10000UL
+
+// A boss fight left through the mode button or a reset; times are game time
+// relative to the moment it was suspended
+struct BossSnapshot {
+  uint32_t fightMs;        // Since the fight started
+  int16_t playerOffset;    // Player position from the middle of playerPos, in 1/256 LED
+  uint16_t sinceAttack;    // Since the running attack started, or the last one ended
+  uint16_t sinceDrop;      // Since the last drop was collected
+  int16_t playerPos;
+  int16_t dropPos;
+  int16_t attackAnchor;    // Player position the running attack was placed from
+  int8_t bossHP;
+  int8_t playerDir;
+  uint8_t attackPattern;
+  uint8_t valid;
+  uint8_t phase2;
+  uint8_t dropActive;
+  uint8_t attackActive;
+};
+
+struct PersistRecord {
+  uint32_t bossBestMs;     // Fastest win, 0 before the first
+  uint32_t clockSeconds;   // Time at the last save, for boards without an RTC
+  uint16_t bossWins;
+  uint8_t mode;            // Mode to come back up in
+  uint8_t reactionDifficulty;
+  uint8_t reactionBest;    // Highest difficulty reached
+  BossSnapshot boss;
+};
+
+extern PersistRecord persisted;
+
+void persistBegin();   // Load the newest valid slot into persisted, or defaults
+void persistTouch();   // persisted changed; save it soon
+bool persistDue();     // Touched, and the rate limit allows a save now
+void persistSave();    // Stage persisted for writing; returns at once
+void persistService(); // Write staged bytes while the EEPROM is ready
+bool persistWriting();
+
+#endif
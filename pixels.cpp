@@ -0,0 +1,226 @@
+#include <string.h>
+
+#include "pixels.h"
+
+#if PIXEL_SIMD && defined(__AVX2__)
+#include <immintrin.h>
+#define PIXEL_AVX2 1
+#endif
+#if PIXEL_SIMD && defined(__SSE2__)
+#include <emmintrin.h>
+#define PIXEL_SSE2 1
+#endif
+
+// The vector loops below handle whole blocks and leave the rest, at most a
+// block, to the scalar loop after them.
+
+#if PIXEL_AVX2 || PIXEL_SSE2
+// 16 (SSE2) or 32 (AVX2) pixels of one color, 48 or 96 bytes: a whole number
+// of both pixels and vectors
+static void fillPattern(uint8_t *pattern, uint16_t pixels, uint32_t color) {
+  for (uint16_t i = 0; i < pixels; i++) {
+    pattern[3 * i] = color >> 8;
+    pattern[3 * i + 1] = color >> 16;
+    pattern[3 * i + 2] = color;
+  }
+}
+#endif
+
+void pixelFill(uint8_t *grb, uint16_t count, uint32_t color) {
+  halCountPixelWrites(count);
+  uint32_t i = 0, n = (uint32_t)count * 3;
+#if PIXEL_AVX2
+  if (n >= 96) {
+    uint8_t pattern[96];
+    fillPattern(pattern, 32, color);
+    __m256i a = _mm256_loadu_si256((const __m256i *)pattern);
+    __m256i b = _mm256_loadu_si256((const __m256i *)(pattern + 32));
+    __m256i c = _mm256_loadu_si256((const __m256i *)(pattern + 64));
+    for (; i + 96 <= n; i += 96) {
+      _mm256_storeu_si256((__m256i *)(grb + i), a);
+      _mm256_storeu_si256((__m256i *)(grb + i + 32), b);
+      _mm256_storeu_si256((__m256i *)(grb + i + 64), c);
+    }
+  }
+#endif
+#if PIXEL_SSE2
+  if (n - i >= 48) {
+    uint8_t pattern[48];
+    fillPattern(pattern, 16, color);
+    __m128i a = _mm_loadu_si128((const __m128i *)pattern);
+    __m128i b = _mm_loadu_si128((const __m128i *)(pattern + 16));
+    __m128i c = _mm_loadu_si128((const __m128i *)(pattern + 32));
+    for (; i + 48 <= n; i += 48) {
+      _mm_storeu_si128((__m128i *)(grb + i), a);
+      _mm_storeu_si128((__m128i *)(grb + i + 16), b);
+      _mm_storeu_si128((__m128i *)(grb + i + 32), c);
+    }
+  }
+#endif
+  uint8_t g = color >> 8, r = color >> 16, b = color;
+  for (; i < n; i += 3) {
+    grb[i] = g;
+    grb[i + 1] = r;
+    grb[i + 2] = b;
+  }
+}
+
+void pixelFillWrap(uint8_t *grb, uint16_t size, uint16_t first, uint16_t count, uint32_t color) {
+  if (count > size) count = size;
+  first %= size;
+  uint16_t head = count < size - first ? count : size - first;
+  pixelFill(grb + 3 * first, head, color);
+  pixelFill(grb, count - head, color);
+}
+
+void pixelScale(uint8_t *grb, uint16_t count, uint8_t scale) {
+  halCountPixelWrites(count);
+  uint32_t i = 0, n = (uint32_t)count * 3;
+  uint16_t factor = scale + 1; // (c * factor) >> 8 keeps 255 unchanged and maps 0 to black
+#if PIXEL_AVX2
+  __m256i f256 = _mm256_set1_epi16(factor), zero256 = _mm256_setzero_si256();
+  for (; i + 32 <= n; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(grb + i));
+    __m256i lo = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(v, zero256), f256), 8);
+    __m256i hi = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(v, zero256), f256), 8);
+    _mm256_storeu_si256((__m256i *)(grb + i), _mm256_packus_epi16(lo, hi)); // Unpack and pack pair up per lane
+  }
+#endif
+#if PIXEL_SSE2
+  __m128i f128 = _mm_set1_epi16(factor), zero128 = _mm_setzero_si128();
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(grb + i));
+    __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(v, zero128), f128), 8);
+    __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(v, zero128), f128), 8);
+    _mm_storeu_si128((__m128i *)(grb + i), _mm_packus_epi16(lo, hi));
+  }
+#endif
+  for (; i < n; i++) grb[i] = (grb[i] * factor) >> 8;
+}
+
+// round(255 * (i / 255) ^ 2.6)
+static const uint8_t gammaTable[256] PROGMEM = {
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,   1,   1,   1,   1,
+    1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,   2,   3,   3,   3,   3,
+    3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   5,   6,   6,   6,   6,   7,
+    7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  10,  11,  11,  11,  12,  12,
+   13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,  20,
+   20,  21,  21,  22,  22,  23,  24,  24,  25,  25,  26,  27,  27,  28,  29,  29,
+   30,  31,  31,  32,  33,  34,  34,  35,  36,  37,  38,  38,  39,  40,  41,  42,
+   42,  43,  44,  45,  46,  47,  48,  49,  50,  51,  52,  53,  54,  55,  56,  57,
+   58,  59,  60,  61,  62,  63,  64,  65,  66,  68,  69,  70,  71,  72,  73,  75,
+   76,  77,  78,  80,  81,  82,  84,  85,  86,  88,  89,  90,  92,  93,  94,  96,
+   97,  99, 100, 102, 103, 105, 106, 108, 109, 111, 112, 114, 115, 117, 119, 120,
+  122, 124, 125, 127, 129, 130, 132, 134, 136, 137, 139, 141, 143, 145, 146, 148,
+  150, 152, 154, 156, 158, 160, 162, 164, 166, 168, 170, 172, 174, 176, 178, 180,
+  182, 184, 186, 188, 191, 193, 195, 197, 199, 202, 204, 206, 209, 211, 213, 215,
+  218, 220, 223, 225, 227, 230, 232, 235, 237, 240, 242, 245, 247, 250, 252, 255,
+};
+
+// A table lookup per byte; there is no vector version, gathers are not faster
+void pixelGamma(uint8_t *grb, uint16_t count) {
+  halCountPixelWrites(count);
+  uint32_t n = (uint32_t)count * 3;
+  for (uint32_t i = 0; i < n; i++) grb[i] = pgm_read_byte(&gammaTable[grb[i]]);
+}
+
+uint8_t pixelGammaLevel(uint8_t level) {
+  return pgm_read_byte(&gammaTable[level]);
+}
+
+uint32_t pixelScaleColor(uint32_t color, uint8_t scale) {
+  uint16_t factor = scale + 1;
+  uint32_t out = 0;
+  for (uint8_t shift = 0; shift < 24; shift += 8) out |= (((color >> shift) & 0xFF) * factor >> 8) << shift;
+  return out;
+}
+
+void pixelAdd(uint8_t *dst, const uint8_t *src, uint16_t count) {
+  halCountPixelWrites(count);
+  uint32_t i = 0, n = (uint32_t)count * 3;
+#if PIXEL_AVX2
+  for (; i + 32 <= n; i += 32) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(dst + i));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(src + i));
+    _mm256_storeu_si256((__m256i *)(dst + i), _mm256_adds_epu8(a, b));
+  }
+#endif
+#if PIXEL_SSE2
+  for (; i + 16 <= n; i += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(dst + i));
+    __m128i b = _mm_loadu_si128((const __m128i *)(src + i));
+    _mm_storeu_si128((__m128i *)(dst + i), _mm_adds_epu8(a, b));
+  }
+#endif
+  for (; i < n; i++) {
+    uint16_t sum = dst[i] + src[i];
+    dst[i] = sum > 255 ? 255 : sum;
+  }
+}
+
+void pixelXor(uint8_t *out, const uint8_t *a, const uint8_t *b, uint16_t count) {
+  uint32_t i = 0, n = (uint32_t)count * 3;
+#if PIXEL_AVX2
+  for (; i + 32 <= n; i += 32) {
+    __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(a + i)),
+                                 _mm256_loadu_si256((const __m256i *)(b + i)));
+    _mm256_storeu_si256((__m256i *)(out + i), x);
+  }
+#endif
+#if PIXEL_SSE2
+  for (; i + 16 <= n; i += 16) {
+    __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i)));
+    _mm_storeu_si128((__m128i *)(out + i), x);
+  }
+#endif
+  for (; i < n; i++) out[i] = a[i] ^ b[i];
+}
+
+// Index of the first byte that differs, n if none
+static uint32_t firstDifference(const uint8_t *a, const uint8_t *b, uint32_t n) {
+  uint32_t i = 0;
+#if PIXEL_SSE2
+  for (; i + 16 <= n; i += 16) {
+    __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i)));
+    unsigned mask = ~_mm_movemask_epi8(eq) & 0xFFFF;
+    if (mask) return i + __builtin_ctz(mask);
+  }
+#endif
+  while (i < n && a[i] == b[i]) i++;
+  return i;
+}
+
+// Index of the last byte that differs; the caller knows there is one
+static uint32_t lastDifference(const uint8_t *a, const uint8_t *b, uint32_t n) {
+  uint32_t end = n;
+#if PIXEL_SSE2
+  for (; end >= 16; end -= 16) {
+    __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a + end - 16)),
+                                _mm_loadu_si128((const __m128i *)(b + end - 16)));
+    unsigned mask = ~_mm_movemask_epi8(eq) & 0xFFFF;
+    if (mask) return end - 16 + 31 - __builtin_clz(mask);
+  }
+#endif
+  while (a[end - 1] == b[end - 1]) end--;
+  return end - 1;
+}
+
+bool pixelDiff(const uint8_t *a, const uint8_t *b, uint16_t count, uint16_t &first, uint16_t &last) {
+  uint32_t n = (uint32_t)count * 3;
+  uint32_t i = firstDifference(a, b, n);
+  if (i == n) return false;
+  first = i / 3;
+  last = lastDifference(a, b, n) / 3;
+  return true;
+}
+
+const char *pixelKernels() {
+#if PIXEL_AVX2
+  return "avx2";
+#elif PIXEL_SSE2
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
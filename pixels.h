@@ -0,0 +1,40 @@
+#ifndef PIXELS_H
+#define PIXELS_H
+
+#include "hal.h"
+
+// Pixel kernels
+//
+// Bulk operations on packed GRB buffers, the layout of
+// Adafruit_NeoPixel::getPixels(), so whole runs of LEDs are written without
+// a setPixelColor() call per pixel. Colors are 0xRRGGBB as everywhere else.
+// Counts are in pixels. Fill, scale, gamma and add report the LEDs they write
+// through halCountPixelWrites(), so bench still counts them.
+//
+// Every kernel has a portable scalar version, which is what the board runs.
+// On x86 the host build adds SSE2 paths, and AVX2 ones when compiled for it
+// (CXXFLAGS="-O2 -mavx2"); -DPIXEL_SIMD=0 forces the scalar code.
+// `host/build/bench --filter pixels` compares the kernels with a plain
+// setPixelColor() loop.
+
+#ifndef PIXEL_SIMD
+#define PIXEL_SIMD 1
+#endif
+
+void pixelFill(uint8_t *grb, uint16_t count, uint32_t color);
+// count pixels from first on a ring of size pixels, wrapping past the end
+void pixelFillWrap(uint8_t *grb, uint16_t size, uint16_t first, uint16_t count, uint32_t color);
+void pixelScale(uint8_t *grb, uint16_t count, uint8_t scale); // Brightness, 255 = unchanged
+void pixelGamma(uint8_t *grb, uint16_t count);                // Perceptual correction, gamma 2.6
+void pixelAdd(uint8_t *dst, const uint8_t *src, uint16_t count); // Per channel, saturating
+void pixelXor(uint8_t *out, const uint8_t *a, const uint8_t *b, uint16_t count);
+// Whether a and b differ; if so, the first and last pixel that do
+bool pixelDiff(const uint8_t *a, const uint8_t *b, uint16_t count, uint16_t &first, uint16_t &last);
+
+// The same for a single value or color
+uint8_t pixelGammaLevel(uint8_t level);
+uint32_t pixelScaleColor(uint32_t color, uint8_t scale);
+
+const char *pixelKernels(); // "avx2", "sse2" or "scalar"
+
+#endif
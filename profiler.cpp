@@ -0,0 +1,152 @@
+#include "settings.h"
+#include "profiler.h"
+#include "telemetry.h"
+
+#if LOOP_PROFILER
+
+struct SectionStats {
+  uint32_t count;
+  uint32_t totalUs;
+  uint16_t minUs;
+  uint16_t maxUs;
+  uint16_t buckets[PROFILE_BUCKETS];
+};
+
+struct Stall {
+  unsigned long at;  // millis
+  uint16_t loopUs;
+  uint8_t section;   // Section with the largest share of the pass
+  uint16_t sectionUs;
+};
+
+static SectionStats stats[PROF_COUNT];
+static Stall stalls[PROFILE_STALLS];
+static uint8_t stallHead = 0;
+static uint32_t stallCount = 0;
+static unsigned long budgetUs = PROFILE_BUDGET_US;
+
+static ProfileScope *innermost = NULL;
+static uint8_t worstSection = PROF_LOOP;
+static unsigned long worstUs = 0;
+
+static int dumpStep = -1; // Next dump record, -1 when not dumping
+
+static uint16_t clampUs(unsigned long us) {
+  return us > 0xFFFF ? 0xFFFF : us;
+}
+
+static void record(uint8_t section, unsigned long us) {
+  SectionStats &s = stats[section];
+  uint16_t clamped = clampUs(us);
+  if (s.count == 0 || clamped < s.minUs) s.minUs = clamped;
+  if (clamped > s.maxUs) s.maxUs = clamped;
+  s.count++;
+  s.totalUs += us;
+
+  // Buckets grow by 4x from 250 us
+  uint8_t bucket = 0;
+  for (unsigned long limit = 250; us >= limit && bucket < PROFILE_BUCKETS - 1; limit <<= 2) bucket++;
+  if (s.buckets[bucket] < 0x7FFF) s.buckets[bucket]++; // Saturate in int16 range for telemetry
+}
+
+ProfileScope::ProfileScope(uint8_t section)
+    : section(section), start(halMicros()), nested(0), outer(innermost) {
+  innermost = this;
+  if (section == PROF_LOOP) worstUs = 0;
+}
+
+ProfileScope::~ProfileScope() {
+  unsigned long elapsed = halMicros() - start;
+  unsigned long self = elapsed - nested;
+  innermost = outer;
+  if (outer) outer->nested += elapsed;
+
+  if (self >= worstUs) {
+    worstUs = self;
+    worstSection = section;
+  }
+
+  if (section != PROF_LOOP) {
+    record(section, self);
+    return;
+  }
+
+  record(PROF_LOOP, elapsed);
+  if (elapsed > budgetUs) {
+    Stall &stall = stalls[stallHead];
+    stall.at = halMillis();
+    stall.loopUs = clampUs(elapsed);
+    stall.section = worstSection;
+    stall.sectionUs = clampUs(worstUs);
+    stallHead = (stallHead + 1) % PROFILE_STALLS;
+    stallCount++;
+  }
+}
+
+void profileSetBudget(unsigned long us) {
+  budgetUs = us;
+}
+
+uint32_t profileStallCount() {
+  return stallCount;
+}
+
+void profileReset() {
+  memset(stats, 0, sizeof(stats));
+  memset(stalls, 0, sizeof(stalls));
+  stallHead = 0;
+  stallCount = 0;
+}
+
+void profileDump() {
+  dumpStep = 0;
+}
+
+// Queue dump record `step`; returns true while it has to wait for room
+static bool dumpRecord(int step) {
+  if (step == 0) {
+    if (!telemetryHasRoom(3)) return true;
+    logEvent(EV_PROFILE_SUMMARY, clampUs(budgetUs), stallCount, stallCount >> 16);
+    return false;
+  }
+  step--;
+
+  if (step < PROF_COUNT * 2) {
+    uint8_t section = step / 2;
+    const SectionStats &s = stats[section];
+    if (step % 2 == 0) {
+      int16_t values[] = { section, (int16_t)s.count, (int16_t)(s.count >> 16), (int16_t)s.minUs,
+                           (int16_t)(s.count ? clampUs(s.totalUs / s.count) : 0), (int16_t)s.maxUs };
+      if (!telemetryHasRoom(6)) return true;
+      logEventValues(EV_PROFILE_SECTION, values, 6);
+    } else {
+      int16_t values[1 + PROFILE_BUCKETS] = { section };
+      for (uint8_t i = 0; i < PROFILE_BUCKETS; i++) values[1 + i] = s.buckets[i];
+      if (!telemetryHasRoom(1 + PROFILE_BUCKETS)) return true;
+      logEventValues(EV_PROFILE_HISTOGRAM, values, 1 + PROFILE_BUCKETS);
+    }
+    return false;
+  }
+  step -= PROF_COUNT * 2;
+
+  // Stalls, oldest first
+  uint8_t kept = stallCount < PROFILE_STALLS ? stallCount : PROFILE_STALLS;
+  if (step >= kept) return false;
+  const Stall &stall = stalls[(stallHead + PROFILE_STALLS - kept + step) % PROFILE_STALLS];
+  int16_t values[] = { (int16_t)stall.loopUs, stall.section, (int16_t)stall.sectionUs,
+                       (int16_t)stall.at, (int16_t)(stall.at >> 16) };
+  if (!telemetryHasRoom(5)) return true;
+  logEventValues(EV_PROFILE_STALL, values, 5);
+  return false;
+}
+
+// Feed a requested dump into telemetry as fast as the ring drains
+void profileService() {
+  while (dumpStep >= 0) {
+    if (dumpRecord(dumpStep)) return; // No room yet
+    dumpStep++;
+    if (dumpStep > 1 + PROF_COUNT * 2 + PROFILE_STALLS) dumpStep = -1;
+  }
+}
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "hal.h"
+#include "profiler_sections.h"
+
+// Loop profiler
+//
+// PROFILE(section) at the top of a block times the rest of the block with
+// halMicros(). Each section keeps a call count, min/avg/max and a histogram;
+// times exclude nested sections, except PROF_LOOP which is the whole pass.
+// A pass longer than the budget is a stall: it is remembered together with
+// the section that used most of it. The serial command 'p' dumps everything
+// as telemetry records, 'r' starts over (see handleSerialCommands()).
+//
+// Build with -DLOOP_PROFILER=0 to compile all of it out.
+
+#ifndef LOOP_PROFILER
+#define LOOP_PROFILER 1
+#endif
+
+#ifndef PROFILE_BUDGET_US
+#define PROFILE_BUDGET_US 10000UL // Stall threshold until a mode sets its own (modes.h)
+#endif
+#define PROFILE_BUCKETS 6         // <250 us, <1 ms, <4 ms, <16 ms, <64 ms, longer
+#define PROFILE_STALLS 4          // Most recent stalls kept
+
+#if LOOP_PROFILER
+
+class ProfileScope {
+public:
+  explicit ProfileScope(uint8_t section);
+  ~ProfileScope();
+
+  uint8_t section;
+  unsigned long start;
+  unsigned long nested; // Time spent in sections inside this one
+  ProfileScope *outer;
+};
+
+#define PROFILE(section) ProfileScope profileScope_(section)
+
+void profileSetBudget(unsigned long us);
+uint32_t profileStallCount(); // Since the last profileReset()
+void profileReset();
+void profileDump();
+void profileService();
+
+#else
+
+#define PROFILE(section)
+
+inline void profileSetBudget(unsigned long us) {}
+inline uint32_t profileStallCount() { return 0; }
+inline void profileReset() {}
+inline void profileDump() {}
+inline void profileService() {}
+
+#endif
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef PROFILER_SECTIONS_H
+#define PROFILER_SECTIONS_H
+
+// Loop profiler sections
+//
+// X(name, label): the device only uses the id; the host telemetry decoder
+// prints the label for %p.
+#define PROFILE_SECTIONS(X)                  \
+  X(LOOP, "loop")                            \
+  X(INPUT, "input")                          \
+  X(MODE_SWITCH, "mode switch")              \
+  X(CLOCK, "clock update")                   \
+  X(CLOCK_RENDER, "clock render")            \
+  X(REACTION, "reaction update")             \
+  X(REACTION_RENDER, "reaction render")      \
+  X(BOSS, "boss update")                     \
+  X(BOSS_RENDER, "boss render")              \
+  X(SHOW, "strip show")                      \
+  X(PERSIST, "persist")                      \
+  X(SERIAL, "serial")
+
+#define PROFILE_SECTION_ID(name, label) PROF_##name,
+enum ProfileSection { PROFILE_SECTIONS(PROFILE_SECTION_ID) PROF_COUNT };
+#undef PROFILE_SECTION_ID
+
+#endif
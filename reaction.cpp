@@ -1,92 +1,208 @@
 #include "functions.h"
 
-// Reaction game variables
-int difficulty = 0;
-
-// Main reaction game loop
-void playReactionGame() {
-  static int target = random(STRIP1_LEDS);  // Target position (red)
-  static int pos = 0;                       // Moving position (yellow)
-  static unsigned long lastMove = 0;        // For controlling LED movement speed
-  static int lastDifficulty = 0;           // Track difficulty changes
-  
-  unsigned long now = millis();
-  
-  // If difficulty changed, move the target
-  if (lastDifficulty != difficulty) {
-    do {
-      target = random(STRIP1_LEDS);
-    } while (target == pos);
-    lastDifficulty = difficulty;
+// The yellow LED runs on a fixed schedule counted in microseconds from an
+// anchor, not from whenever the loop polls it, so its position at any past
+// instant is known exactly. A press is judged at its interrupt timestamp
+// against the windows the yellow LED spends on the target; loop jitter only
+// delays the drawing. It is drawn gliding between LEDs, right on each one
+// halfway through its window there.
+
+// Re-time the yellow LED from where it is now at the current difficulty's
+// speed and start a new attempt
+static void startReactionAttempt() {
+  ReactionState &r = reactionState;
+  // 50 ms per step at the start, 10 ms at max difficulty
+  r.stepMicros = map(r.difficulty, 0, STRIP2_LEDS - 1, 50, 10) * 1000UL;
+  r.anchorPos = r.pos;
+  r.anchorMicros = halMicros();
+  r.attemptStart = r.anchorMicros;
+}
+
+// Start the next attempt: a new target away from the yellow LED, which is
+// re-timed from there at the current difficulty's speed. The only place an
+// attempt after the first one starts.
+void newReactionAttempt() {
+  ReactionState &r = reactionState;
+  do {
+    r.target = rngNext(RNG_REACTION, STRIP1_LEDS);
+  } while (r.target == r.pos);
+  startReactionAttempt();
+}
+
+// Position of the yellow LED at `micros`, 8.8 fixed point
+static long reactionFixedAt(unsigned long micros) {
+  ReactionState &r = reactionState;
+  long since = (long)(micros - r.anchorMicros);
+  if (since < 0) since = 0;
+  int steps = since / r.stepMicros % Arena::size;
+  long within = (since % r.stepMicros) * POS_ONE / r.stepMicros;
+  return Arena::wrapFixed((long)(r.anchorPos + steps) * POS_ONE + within - POS_ONE / 2);
+}
+
+// The LED the yellow LED is on at `micros`, the one the press is judged by
+static int reactionPosAt(unsigned long micros) {
+  return Arena::led(reactionFixedAt(micros));
+}
+
+// Signed time from the middle of the nearest window the yellow LED spends
+// on the target to `micros`; within half a step means it was on the target
+static long reactionErrorAt(unsigned long micros) {
+  ReactionState &r = reactionState;
+  long step = r.stepMicros;
+  long lap = (long)Arena::size * step;
+  long since = (long)(micros - r.anchorMicros);
+  if (since < 0) since = 0;
+  long error = (since - Arena::wrap(r.target - r.anchorPos) * step - step / 2) % lap;
+  if (error < -lap / 2) error += lap;
+  if (error >= lap / 2) error -= lap;
+  return error;
+}
+
+// Time from when the yellow LED last reached the target to `micros`, the
+// reaction time of a press; 0 if it has not got there yet this attempt
+static unsigned long reactionLatencyAt(unsigned long micros) {
+  ReactionState &r = reactionState;
+  long step = r.stepMicros;
+  long lap = (long)Arena::size * step;
+  long arrive = Arena::wrap(r.target - r.anchorPos) * step;
+  if (micros - r.attemptStart < (unsigned long)arrive) return 0;
+  long late = ((long)(micros - r.anchorMicros) - arrive) % lap;
+  return late < 0 ? late + lap : late;
+}
+
+// Start a fresh game when the mode is entered
+void resetReaction() {
+  reactionState = ReactionState();
+  reactionState.target = rngNext(RNG_REACTION, STRIP1_LEDS);
+  // Carry on at the difficulty reached last time
+  if (persisted.reactionDifficulty < STRIP2_LEDS) {
+    reactionState.difficulty = persisted.reactionDifficulty;
   }
-  
-  // Calculate speed based on difficulty (starts faster, gets very fast)
-  int baseDelay = map(difficulty, 0, STRIP2_LEDS-1, 50, 10); // 50ms at start, 10ms at max difficulty
-  
-  // Move the yellow LED based on speed
-  if (now - lastMove > baseDelay) {
-    pos = (pos + 1) % STRIP1_LEDS;  // Wrap around
-    lastMove = now;
-    
-    // Print debug info
-    Serial.print("Target: ");
-    Serial.print(target);
-    Serial.print(" Pos: ");
-    Serial.print(pos);
-    Serial.print(" Difficulty: ");
-    Serial.println(difficulty);
+  startReactionAttempt();
+}
+
+// Leaving the mode ends the session, its state is about to be reused
+void endReaction() {
+  if (reactionState.stats.attempts > 0) reactionStatsDump();
+}
+
+// Main reaction game loop: move the yellow LED, then judge presses
+bool updateReaction() {
+  ReactionState &r = reactionState;
+
+  // A lap later the yellow LED is back where it started, so moving the
+  // anchor on by whole laps leaves the schedule as it is. Keeping at least a
+  // lap behind now still places presses made before this pass, and the time
+  // since the anchor stays within a long on the board (2^31 us is 36 min).
+  unsigned long now = halMicros();
+  unsigned long lap = (unsigned long)Arena::size * r.stepMicros;
+  while (now - r.anchorMicros >= 2 * lap) r.anchorMicros += lap;
+
+  // Move the yellow LED to where the schedule has it
+  r.fixedPos = reactionFixedAt(now);
+  int pos = Arena::led(r.fixedPos);
+  if (pos != r.pos) {
+    r.pos = pos;
+
+    // Log debug info
+    logEvent(EV_REACTION_STEP, r.target, r.pos, r.difficulty);
   }
 
-  updateReactionDisplay(target, pos);
-  handleReactionInput(pos, target);
+  handleReactionInput(r.pos, r.target);
+  return true;
 }
 
-// Update LED display for reaction game
-void updateReactionDisplay(int target, int pos) {
-  clearStrips();
+void drawReaction() {
+  updateReactionDisplay(reactionState.target, reactionState.fixedPos);
+}
+
+// Update LED display for reaction game; pos is 8.8 fixed point
+void updateReactionDisplay(int target, long pos) {
+  PROFILE(PROF_REACTION_RENDER);
+  composeBegin();
 
   // Red target (single LED)
-  strip1.setPixelColor(target, strip1.Color(255, 0, 0));
+  composePixel(LAYER_MARKS, REGION_PLAY, target, COLOR_TARGET);
 
   // Yellow moving position
-  strip1.setPixelColor(pos, strip1.Color(255, 255, 0));
+  composeDot(LAYER_PLAYER, REGION_PLAY, pos, COLOR_RUNNER);
 
-  // Show difficulty level on strip2
-  for (int i = 0; i < difficulty; i++) {
-    strip2.setPixelColor(i, strip2.Color(255, 255, 0));
-  }
+  // Show difficulty level on the status bar
+  composeSpan(LAYER_BACKGROUND, REGION_STATUS, 0, reactionState.difficulty, COLOR_DIFFICULTY);
 
-  strip1.show();
-  strip2.show();
+  composeFlush();
 }
 
-// Handle button input for reaction game
+// Start the debounce window once the hit/miss flash has finished; the
+// yellow LED stood still during the flash, so the next attempt starts here
+static void markReactionInput() {
+  reactionState.lastInput = halMicros();
+  newReactionAttempt();
+}
+
+// Fold one attempt into the session statistics and log it
+static void recordReactionAttempt(unsigned long latency, long error, bool hit) {
+  ReactionStats &s = reactionState.stats;
+  if (s.attempts == 0xFFFF) return;
+  s.attempts++;
+  if (hit) s.hits++;
+  if (s.attempts == 1 || latency < s.latencyMin) s.latencyMin = latency;
+  if (latency > s.latencyMax) s.latencyMax = latency;
+
+  // Running means, so a long session cannot overflow a sum
+  unsigned long absError = error < 0 ? -error : error;
+  s.latencyAvg += ((long)latency - (long)s.latencyAvg) / (long)s.attempts;
+  s.errorAvg += ((long)absError - (long)s.errorAvg) / (long)s.attempts;
+
+  int16_t values[] = { (int16_t)latency, (int16_t)(latency >> 16), (int16_t)error, (int16_t)(error >> 16),
+                       (int16_t)reactionState.stepMicros };
+  logEventValues(EV_REACTION_ATTEMPT, values, 5);
+}
+
+// Log the statistics of the running session
+void reactionStatsDump() {
+  const ReactionStats &s = reactionState.stats;
+  int16_t stats[] = { (int16_t)s.attempts, (int16_t)s.hits, (int16_t)s.errorAvg, (int16_t)(s.errorAvg >> 16) };
+  logEventValues(EV_REACTION_STATS, stats, 4);
+  int16_t latency[] = { (int16_t)s.latencyAvg, (int16_t)(s.latencyAvg >> 16), (int16_t)s.latencyMin,
+                        (int16_t)(s.latencyMin >> 16), (int16_t)s.latencyMax, (int16_t)(s.latencyMax >> 16) };
+  logEventValues(EV_REACTION_LATENCY, latency, 6);
+}
+
+// Handle button input for reaction game: the press is judged at the time
+// it was made, not at the time it is polled
 void handleReactionInput(int pos, int target) {
-  if (!digitalRead(BTN_ACTION)) {
-    if (pos == target) {  // Must hit exactly on target
-      successFlash();
-      if (difficulty < STRIP2_LEDS-1) {
-        difficulty++;
-        Serial.print("HIT! New difficulty: ");
-        Serial.println(difficulty);
+  ReactionState &r = reactionState;
+  ButtonEvent press;
+  if (takePress(BTN_ACTION, press)) {
+    // Ignore presses made during the flash or the 200 ms after it
+    if ((long)(press.micros - r.lastInput) < 200000L) return;
+
+    long error = reactionErrorAt(press.micros);
+    bool hit = error >= -(long)r.stepMicros / 2 && error < (long)r.stepMicros / 2;  // Must hit exactly on target
+    recordReactionAttempt(reactionLatencyAt(press.micros), error, hit);
+
+    if (hit) {
+      successFlash(markReactionInput);
+      if (r.difficulty < STRIP2_LEDS-1) {
+        r.difficulty++;
+        logEvent(EV_REACTION_HIT, r.difficulty);
       } else {
-        Serial.println("PERFECT! Maximum difficulty!");
+        logEvent(EV_REACTION_PERFECT);
       }
     } else {
-      failFlash();
-      if (difficulty > 0) {
-        difficulty--;
-        Serial.print("MISS! New difficulty: ");
-        Serial.println(difficulty);
+      failFlash(markReactionInput);
+      if (r.difficulty > 0) {
+        r.difficulty--;
+        logEvent(EV_REACTION_MISS, r.difficulty);
       }
     }
 
-    // Generate new target position (make sure it's not at current position)
-    do {
-      target = random(STRIP1_LEDS);
-    } while (target == pos);
-    
-    delay(200); // Shorter debounce for faster gameplay
+    persisted.reactionDifficulty = r.difficulty;
+    if (r.difficulty > persisted.reactionBest) persisted.reactionBest = r.difficulty;
+    persistTouch();
+
+    // The yellow LED stops where it was pressed until the next attempt
+    r.pos = reactionPosAt(press.micros);
   }
 }
-}
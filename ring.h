@@ -0,0 +1,62 @@
+#ifndef RING_H
+#define RING_H
+
+#include "settings.h"
+
+// Compile-time ring geometry
+//
+// The modes take their ring size from these types instead of doing their own
+// arithmetic on STRIP1_LEDS, so the same code serves 24-, 60-, 144- and
+// 300-LED rings. Everything here folds to constants; for a power-of-two ring
+// wrap() is a single AND.
+
+template <int N>
+struct Ring {
+  static_assert(N > 1, "a ring needs at least two LEDs");
+  static_assert(N <= 1024, "positions and zone math assume rings up to 1024 LEDs");
+
+  static constexpr int size = N;
+  static constexpr bool powerOfTwo = (N & (N - 1)) == 0;
+  static constexpr long fixedSize = (long)N * POS_ONE; // The ring in sub-LED positions
+
+  // Any position, however many laps away, onto [0, N)
+  static constexpr int wrap(int pos) {
+    return powerOfTwo ? (pos & (N - 1)) : (pos % N + N) % N;
+  }
+
+  // Sub-LED position (8.8 fixed point, POS_ONE per LED) onto [0, N * POS_ONE)
+  static constexpr long wrapFixed(long pos) {
+    return powerOfTwo ? (pos & (fixedSize - 1)) : (pos % fixedSize + fixedSize) % fixedSize;
+  }
+
+  // A wrapped sub-LED position moved by less than a lap either way; no
+  // division, unlike wrapFixed(), so it suits every tick
+  static constexpr long stepFixed(long pos, long delta) {
+    return pos + delta < 0 ? pos + delta + fixedSize : pos + delta >= fixedSize ? pos + delta - fixedSize : pos + delta;
+  }
+
+  // The LED nearest to a wrapped sub-LED position: only the last half LED
+  // rounds up past the end
+  static constexpr int led(long pos) {
+    return pos + POS_ONE / 2 >= fixedSize ? 0 : (int)((pos + POS_ONE / 2) / POS_ONE);
+  }
+
+  // num/den of the ring, rounded, but never less than one LED
+  static constexpr int part(int num, int den) {
+    return ((long)N * num + den / 2) / den > 0 ? ((long)N * num + den / 2) / den : 1;
+  }
+};
+
+template <int N> constexpr int Ring<N>::size;
+template <int N> constexpr bool Ring<N>::powerOfTwo;
+template <int N> constexpr long Ring<N>::fixedSize;
+
+typedef Ring<STRIP1_LEDS> Arena; // Play ring, where the modes play
+typedef Ring<STRIP2_LEDS> Gauge; // Status bar: HP / difficulty / backdrop
+
+// Toroidal position wrapping for the circular play strip
+constexpr int wrapPosition(int pos) {
+  return Arena::wrap(pos);
+}
+
+#endif
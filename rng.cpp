@@ -0,0 +1,39 @@
+#include "rng.h"
+#include "telemetry.h"
+
+static uint32_t sessionSeed = 0;
+static uint32_t streams[RNG_STREAM_COUNT];
+
+// splitmix32 step, spreads one seed into independent stream states
+static uint32_t mix(uint32_t x) {
+  x += 0x9E3779B9UL;
+  x = (x ^ (x >> 16)) * 0x85EBCA6BUL;
+  x = (x ^ (x >> 13)) * 0xC2B2AE35UL;
+  return x ^ (x >> 16);
+}
+
+// Seed every stream from the session seed and log it for replay
+void rngBegin(uint32_t seed) {
+  sessionSeed = seed;
+  uint32_t x = seed;
+  for (uint8_t i = 0; i < RNG_STREAM_COUNT; i++) {
+    x = mix(x);
+    streams[i] = x ? x : 1; // xorshift must not start at zero
+  }
+  logEvent(EV_SESSION_SEED, seed & 0xFFFF, seed >> 16);
+}
+
+uint32_t rngSeed() {
+  return sessionSeed;
+}
+
+// Uniform-ish value in [0, maxValue) from a stream (xorshift32)
+long rngNext(RngStream stream, long maxValue) {
+  if (maxValue <= 0) return 0;
+  uint32_t x = streams[stream];
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  streams[stream] = x;
+  return (long)(x % (uint32_t)maxValue);
+}
@@ -0,0 +1,23 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include "hal.h"
+
+// Seeded random number streams
+//
+// Each subsystem draws from its own stream, all derived from one session
+// seed, so a change in how often one subsystem rolls does not shift what the
+// others see, and a logged seed reproduces a whole session.
+
+enum RngStream {
+  RNG_REACTION,  // Reaction targets
+  RNG_DROPS,     // Boss fight drop positions
+  RNG_ATTACKS,   // Boss fight attack pattern choice
+  RNG_STREAM_COUNT
+};
+
+void rngBegin(uint32_t seed);
+uint32_t rngSeed();
+long rngNext(RngStream stream, long maxValue);
+
+#endif
@@ -0,0 +1,80 @@
+#include <Wire.h>
+
+#include "settings.h"
+#include "timekeeping.h"
+
+// DS3231 real-time clock on I2C (A4/A5 on the Uno)
+
+#define DS3231_ADDRESS 0x68
+#define DS3231_TIME_REG 0x00
+#define DS3231_STATUS_REG 0x0F
+#define DS3231_OSF 0x80  // Oscillator stopped: time is not valid
+
+static uint8_t bcdToBin(uint8_t v) {
+  return (v >> 4) * 10 + (v & 0x0F);
+}
+
+static uint8_t binToBcd(uint8_t v) {
+  return ((v / 10) << 4) | (v % 10);
+}
+
+static bool readRegisters(uint8_t reg, uint8_t *buf, uint8_t count) {
+  Wire.beginTransmission(DS3231_ADDRESS);
+  Wire.write(reg);
+  if (Wire.endTransmission() != 0) return false;
+  if (Wire.requestFrom((uint8_t)DS3231_ADDRESS, count) != count) return false;
+  for (uint8_t i = 0; i < count; i++) buf[i] = Wire.read();
+  return true;
+}
+
+static bool ds3231Begin() {
+  Wire.begin();
+  Wire.beginTransmission(DS3231_ADDRESS);
+  return Wire.endTransmission() == 0;
+}
+
+static bool ds3231Read(uint32_t &seconds) {
+  uint8_t status;
+  if (!readRegisters(DS3231_STATUS_REG, &status, 1) || (status & DS3231_OSF)) return false;
+
+  uint8_t r[7];
+  if (!readRegisters(DS3231_TIME_REG, r, 7)) return false;
+
+  int hour;
+  if (r[2] & 0x40) {
+    // 12-hour mode, bit 5 is PM
+    hour = bcdToBin(r[2] & 0x1F) % 12 + ((r[2] & 0x20) ? 12 : 0);
+  } else {
+    hour = bcdToBin(r[2] & 0x3F);
+  }
+  seconds = secondsFromDate(2000 + bcdToBin(r[6]), bcdToBin(r[5] & 0x1F), bcdToBin(r[4]),
+                            hour, bcdToBin(r[1]), bcdToBin(r[0] & 0x7F));
+  return true;
+}
+
+static bool ds3231Write(uint32_t seconds) {
+  int year, month, day, hour, minute, second;
+  dateFromSeconds(seconds, year, month, day, hour, minute, second);
+  uint8_t dayOfWeek = (seconds / 86400 + 5) % 7 + 1; // 2000-01-01 was a Saturday
+
+  Wire.beginTransmission(DS3231_ADDRESS);
+  Wire.write(DS3231_TIME_REG);
+  Wire.write(binToBcd(second));
+  Wire.write(binToBcd(minute));
+  Wire.write(binToBcd(hour)); // 24-hour mode
+  Wire.write(dayOfWeek);
+  Wire.write(binToBcd(day));
+  Wire.write(binToBcd(month));
+  Wire.write(binToBcd(year - 2000));
+  if (Wire.endTransmission() != 0) return false;
+
+  // Clear the oscillator-stopped flag now that the time is valid
+  uint8_t status;
+  if (!readRegisters(DS3231_STATUS_REG, &status, 1)) return false;
+  Wire.beginTransmission(DS3231_ADDRESS);
+  Wire.write(DS3231_STATUS_REG);
+  Wire.write(status & ~DS3231_OSF);
+  return Wire.endTransmission() == 0;
+}
+
+const TimeSource ds3231TimeSource = { ds3231Begin, ds3231Read, ds3231Write };
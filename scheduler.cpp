@@ -0,0 +1,96 @@
+#include "scheduler.h"
+
+// Task table
+struct Task {
+  TaskFn fn;
+  unsigned long due;
+  unsigned long period;
+  bool periodic;
+  bool active;
+};
+
+static Task tasks[MAX_TASKS];
+
+static int addTask(TaskFn fn, unsigned long delayMs, unsigned long periodMs, bool periodic) {
+  for (int i = 0; i < MAX_TASKS; i++) {
+    if (!tasks[i].active) {
+      tasks[i].fn = fn;
+      tasks[i].due = halMillis() + delayMs;
+      tasks[i].period = periodMs;
+      tasks[i].periodic = periodic;
+      tasks[i].active = true;
+      return i;
+    }
+  }
+  return -1;
+}
+
+int scheduleTask(TaskFn fn, unsigned long delayMs) {
+  return addTask(fn, delayMs, 0, false);
+}
+
+int scheduleEvery(TaskFn fn, unsigned long periodMs) {
+  return addTask(fn, 0, periodMs, true);
+}
+
+void setTaskPeriod(int id, unsigned long periodMs) {
+  if (id < 0 || id >= MAX_TASKS) return;
+  tasks[id].period = periodMs;
+  tasks[id].due = halMillis();
+}
+
+void cancelTask(int id) {
+  if (id >= 0 && id < MAX_TASKS) tasks[id].active = false;
+}
+
+// Dispatch every task whose deadline has passed (wrap-safe comparison)
+void runScheduler() {
+  for (int i = 0; i < MAX_TASKS; i++) {
+    Task &task = tasks[i];
+    unsigned long now = halMillis();
+    if (!task.active || (long)(now - task.due) < 0) continue;
+
+    if (task.periodic) {
+      task.due += task.period;
+      // Skip missed periods instead of bursting to catch up
+      if ((long)(now - task.due) >= 0) task.due = now + task.period;
+    } else {
+      task.active = false;
+    }
+    task.fn();
+  }
+}
+
+// Effects
+static EffectFn currentEffect = NULL;
+static TaskFn effectThen = NULL;
+static Pt effectPt;
+static int effectTask = -1;
+
+static void stepEffect() {
+  if (!currentEffect || !currentEffect(&effectPt)) return;
+
+  TaskFn then = effectThen;
+  stopEffect();
+  if (then) then();
+}
+
+void playEffect(EffectFn effect, TaskFn then) {
+  stopEffect();
+  currentEffect = effect;
+  effectThen = then;
+  effectPt.line = 0;
+  effectTask = scheduleEvery(stepEffect, 0);
+  stepEffect(); // First step right away so the effect shows this frame
+}
+
+void stopEffect() {
+  cancelTask(effectTask);
+  effectTask = -1;
+  currentEffect = NULL;
+  effectThen = NULL;
+}
+
+bool effectRunning() {
+  return currentEffect != NULL;
+}
@@ -0,0 +1,50 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "hal.h"
+
+// Cooperative scheduler
+//
+// loop() never blocks: frame pacing, debounce windows and visual effects are
+// tasks with deadlines that runScheduler() dispatches once they are due.
+
+#define MAX_TASKS 8
+
+typedef void (*TaskFn)();
+
+// Run fn once after delayMs, or every periodMs (0 = every scheduler pass).
+// Both return a task id, or -1 when the task table is full.
+int scheduleTask(TaskFn fn, unsigned long delayMs);
+int scheduleEvery(TaskFn fn, unsigned long periodMs);
+void setTaskPeriod(int id, unsigned long periodMs);
+void cancelTask(int id);
+void runScheduler();
+
+// Protothread-style resumable effects. An effect is a function that returns
+// true when finished; PT_WAIT_MS() yields back to the loop until the wait is
+// over and resumes at the same spot. Locals do not survive a yield, so keep
+// loop counters static.
+struct Pt {
+  unsigned short line;
+  unsigned long wakeAt;
+};
+
+typedef bool (*EffectFn)(Pt *pt);
+
+#define PT_BEGIN(pt) switch ((pt)->line) { case 0:
+#define PT_WAIT_MS(pt, ms)                                          \
+  do {                                                              \
+    (pt)->wakeAt = halMillis() + (ms);                              \
+    (pt)->line = __LINE__;                                          \
+    case __LINE__:                                                  \
+    if ((long)(halMillis() - (pt)->wakeAt) < 0) return false;       \
+  } while (0)
+#define PT_END(pt) } (pt)->line = 0; return true;
+
+// Only one effect plays at a time; it owns the strips until it finishes,
+// then the optional follow-up task runs.
+void playEffect(EffectFn effect, TaskFn then = NULL);
+void stopEffect();
+bool effectRunning();
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef STATE_H
+#define STATE_H
+
+#include "settings.h"
+#include "attacks.h"
+
+// Per-mode game state
+//
+// Only the active mode needs live state, so the three modes share one
+// arena and each mode's reset function fully initializes its member when the
+// mode is entered (see setMode()). Fields are sized for what they hold:
+// positions fit rings up to 1024 LEDs (ring.h), times that are compared with
+// halMillis() (or the boss fight's game time) stay unsigned long.
+
+#define BOSS_INITIAL_DELAY_MS 3000 // Before the first attack
+#define SIM_TICK_MS 10             // Boss fight simulation step, see updateBossFight()
+#define SIM_MAX_CATCHUP 10         // Ticks run at most per frame to catch up
+
+// Boss fight balance. Constant on the board; the host build leaves it
+// writable so host/balance can sweep it.
+#ifdef HOST_BUILD
+#define TUNABLE
+#else
+#define TUNABLE const
+#endif
+
+struct BossTuning {
+  uint16_t attackCooldownMs;   // Between attacks in phase 1
+  uint16_t phase2CooldownMs;   // ... and in phase 2
+  uint16_t dropCooldownMs;     // Between a collected drop and the next
+  uint16_t playerSpeed;        // LEDs per second, 8.8 fixed point
+  uint8_t phase2SpeedPct;      // Player speed in phase 2, percent of playerSpeed
+  uint8_t warningPct;          // Shortens every attack warning, at most 100
+};
+
+extern TUNABLE BossTuning bossTuning;
+
+// A speed over one tick: whole 1/256 LEDs, and the rest in 1/1000 of one
+struct PlayerStride {
+  uint16_t step;
+  uint16_t rest;
+};
+
+struct ClockState {
+  uint32_t shownSecond;        // Second currently on the ring
+  unsigned long lastLog;
+};
+
+// Per-session reaction statistics, all times in microseconds
+struct ReactionStats {
+  uint16_t attempts;
+  uint16_t hits;
+  unsigned long latencyAvg;    // Press after the yellow LED reached the target, running mean
+  unsigned long latencyMin;
+  unsigned long latencyMax;
+  unsigned long errorAvg;      // Distance from the middle of the target window
+};
+
+struct ReactionState {
+  int16_t target;              // Red LED
+  int16_t pos;                 // Moving yellow LED, as last drawn
+  long fixedPos;               // ... and where between LEDs, 8.8 fixed point
+  uint8_t difficulty;
+  int16_t anchorPos;           // Where the yellow LED was at anchorMicros
+  unsigned long anchorMicros;  // Steps are counted from here, kept within two laps of now
+  unsigned long stepMicros;    // How long the yellow LED sits on each LED
+  unsigned long attemptStart;  // When the current target was shown (us)
+  unsigned long lastInput;     // When the last hit/miss flash ended (us)
+  ReactionStats stats;
+};
+
+struct BossState {
+  // Player: moves smoothly in 8.8 fixed point, collides on the nearest LED
+  int16_t playerPos;           // Arena::led(playerFixed)
+  int8_t playerDir;
+  int8_t bossHP;
+  long playerFixed;            // Position, 8.8 fixed point
+  uint16_t playerSpeed;        // LEDs per second, 8.8 fixed point
+  uint16_t playerRate;         // Derived from playerSpeed and phase
+  PlayerStride playerStride;   // playerRate per tick, see tickStride()
+  uint16_t playerCarry;        // Travel short of a whole 1/256 LED, see playerTravel()
+
+  // Attack system (patterns live in attacks.h)
+  bool attackActive;
+  bool phase2;
+  uint8_t attackPattern;
+  uint16_t attackCooldown;
+  uint16_t attackWarningMs;    // HP-scaled timings of the running attack
+  uint16_t attackFlashMs;
+  bool attackBlinkOn;          // Warning zones lit, see advanceAttackBlink()
+  unsigned long attackBlinkMs; // Into the attack when the blink next toggles
+  int16_t attackAnchor;        // Player position the zones were placed from
+  unsigned long attackStartTime;
+  unsigned long lastAttackTime;
+  AttackPattern attack;        // Copied from flash by startAttack()
+  HazardMap hazard;            // LEDs the running attack covers
+
+  // Drops
+  bool dropActive;
+  int16_t dropPos;
+  unsigned long lastDropTime;
+  unsigned long fightStartTime;
+
+  // Game time of the current tick; it runs simLagMs behind halMillis() once
+  // ticks had to be dropped. Every time above is game time.
+  unsigned long simMs;
+  unsigned long simLagMs;
+};
+
+union ModeState {
+  ClockState clock;
+  ReactionState reaction;
+  BossState boss;
+};
+
+extern ModeState modeState;
+
+// Constant aliases, folded to direct addresses by the compiler
+static constexpr ClockState &clockState = modeState.clock;
+static constexpr ReactionState &reactionState = modeState.reaction;
+static constexpr BossState &bossState = modeState.boss;
+
+#endif
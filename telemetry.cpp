@@ -0,0 +1,102 @@
+#include "settings.h"
+#include "telemetry.h"
+
+// Level of every event, indexed by id
+#define TELEMETRY_EVENT_LEVEL(name, level, format) level,
+static const uint8_t eventLevels[] PROGMEM = { TELEMETRY_EVENTS(TELEMETRY_EVENT_LEVEL) };
+#undef TELEMETRY_EVENT_LEVEL
+
+static uint8_t ring[TELEMETRY_BUFFER];
+static uint8_t ringHead = 0;
+static uint8_t ringTail = 0;
+static uint8_t minLevel = TLM_INFO;
+static unsigned int dropped = 0;        // Total since boot
+static unsigned int droppedUnreported = 0;
+
+void setTelemetryLevel(TelemetryLevel level) {
+  minLevel = level;
+}
+
+unsigned int droppedTelemetry() {
+  return dropped;
+}
+
+static uint8_t ringFree() {
+  return (TELEMETRY_BUFFER - 1) - ((ringHead - ringTail) & (TELEMETRY_BUFFER - 1));
+}
+
+static void put(uint8_t b, uint8_t &checksum) {
+  ring[ringHead] = b;
+  ringHead = (ringHead + 1) & (TELEMETRY_BUFFER - 1);
+  checksum ^= b;
+}
+
+static void writeRecord(uint8_t id, const int16_t *values, uint8_t count) {
+  uint8_t checksum = 0;
+  unsigned long now = halMillis();
+
+  put(TELEMETRY_SYNC, checksum);
+  checksum = 0;
+  put(id, checksum);
+  put(count * 2, checksum);
+  for (uint8_t i = 0; i < 4; i++) put(now >> (8 * i), checksum);
+  for (uint8_t i = 0; i < count; i++) {
+    put(values[i], checksum);
+    put((uint16_t)values[i] >> 8, checksum);
+  }
+  uint8_t unused = 0;
+  put(checksum, unused);
+}
+
+static uint8_t recordSize(uint8_t count) {
+  return 8 + count * 2;
+}
+
+// Queue an event record; drops it (and counts the drop) if the ring is full
+void logEventValues(uint8_t id, const int16_t *values, uint8_t count) {
+  if (id >= EV_COUNT || pgm_read_byte(&eventLevels[id]) < minLevel) return;
+  if (count > TELEMETRY_MAX_VALUES) count = TELEMETRY_MAX_VALUES;
+
+  uint8_t needed = recordSize(count);
+  if (droppedUnreported) needed += recordSize(1);
+  if (ringFree() < needed) {
+    dropped++;
+    droppedUnreported++;
+    return;
+  }
+
+  if (droppedUnreported) {
+    int16_t lost = droppedUnreported;
+    writeRecord(EV_TELEMETRY_DROPPED, &lost, 1);
+    droppedUnreported = 0;
+  }
+  writeRecord(id, values, count);
+}
+
+// Whether a record with count values would be queued now rather than dropped
+bool telemetryHasRoom(uint8_t count) {
+  uint8_t needed = recordSize(count);
+  if (droppedUnreported) needed += recordSize(1);
+  return ringFree() >= needed;
+}
+
+// Whether a record of another stream (frame capture) fits in the ring as a
+// whole; its bytes then follow through telemetryPutRaw()
+bool telemetryBeginRaw(uint16_t bytes) {
+  if (droppedUnreported) bytes += recordSize(1); // Keep room to report drops
+  return bytes <= ringFree();
+}
+
+void telemetryPutRaw(uint8_t b) {
+  uint8_t unused = 0;
+  put(b, unused);
+}
+
+// Hand queued bytes to the UART, only as many as fit without blocking
+void flushTelemetry() {
+  int room = Serial.availableForWrite();
+  while (room-- > 0 && ringTail != ringHead) {
+    Serial.write(ring[ringTail]);
+    ringTail = (ringTail + 1) & (TELEMETRY_BUFFER - 1);
+  }
+}
@@ -0,0 +1,48 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "hal.h"
+#include "telemetry_events.h"
+
+// Buffered binary telemetry
+//
+// logEvent() appends a compact record to a RAM ring and never blocks;
+// flushTelemetry() moves as many bytes as the UART can take without waiting.
+// When the ring is full the record is dropped and counted, and the count is
+// reported once there is room again. host/tlmdecode turns the stream back
+// into text.
+//
+// Record: 0xA5, id, payload length, 32-bit LE millis, payload (16-bit LE
+// values), XOR checksum of everything after the sync byte.
+
+#define TELEMETRY_BUFFER 128  // Power of two
+#define TELEMETRY_SYNC 0xA5
+#define TELEMETRY_MAX_VALUES 8
+
+void setTelemetryLevel(TelemetryLevel level);
+void logEventValues(uint8_t id, const int16_t *values, uint8_t count);
+bool telemetryHasRoom(uint8_t count);
+bool telemetryBeginRaw(uint16_t bytes); // Room for a foreign record (see framecap.h)?
+void telemetryPutRaw(uint8_t b);         // One of its bytes, after telemetryBeginRaw()
+void flushTelemetry();
+unsigned int droppedTelemetry();
+
+inline void logEvent(uint8_t id) {
+  logEventValues(id, NULL, 0);
+}
+
+inline void logEvent(uint8_t id, int16_t a) {
+  logEventValues(id, &a, 1);
+}
+
+inline void logEvent(uint8_t id, int16_t a, int16_t b) {
+  int16_t values[] = { a, b };
+  logEventValues(id, values, 2);
+}
+
+inline void logEvent(uint8_t id, int16_t a, int16_t b, int16_t c) {
+  int16_t values[] = { a, b, c };
+  logEventValues(id, values, 3);
+}
+
+#endif
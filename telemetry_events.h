@@ -0,0 +1,53 @@
+#ifndef TELEMETRY_EVENTS_H
+#define TELEMETRY_EVENTS_H
+
+// Telemetry event catalog
+//
+// X(name, level, format): the device only uses the id and level; the host
+// decoder turns records back into text with the format. %d takes the next
+// payload value, %l the next two as one unsigned 32-bit value (low word
+// first), %i the same as a signed value, %a / %h print the announcement /
+// hit message of the attack pattern given by the next value, %u prints the
+// next value unsigned, %p the name of the profiler section it holds
+// (profiler_sections.h), %z prints all remaining values.
+#define TELEMETRY_EVENTS(X)                                                     \
+  X(STARTED, TLM_INFO, "=== Boss Fight Game Started ===")                      \
+  X(MODE_CLOCK, TLM_INFO, ">> Mode: CLOCK")                                    \
+  X(MODE_REACTION, TLM_INFO, ">> Mode: REACTION")                              \
+  X(MODE_BOSS, TLM_INFO, ">> Mode: BOSS")                                      \
+  X(CLOCK_TIME, TLM_INFO, "Clock - H:%d M:%d S:%d")                            \
+  X(REACTION_STEP, TLM_DEBUG, "Target: %d Pos: %d Difficulty: %d")             \
+  X(REACTION_HIT, TLM_INFO, "HIT! New difficulty: %d")                         \
+  X(REACTION_PERFECT, TLM_INFO, "PERFECT! Maximum difficulty!")                \
+  X(REACTION_MISS, TLM_INFO, "MISS! New difficulty: %d")                       \
+  X(REACTION_ATTEMPT, TLM_INFO, "Pressed %l us after the target, %i us off it (window %u us)") \
+  X(REACTION_STATS, TLM_INFO, "[reaction] %u attempts, %u hits, mean error %l us") \
+  X(REACTION_LATENCY, TLM_INFO, "[reaction] latency avg %l min %l max %l us")   \
+  X(BOSS_RESET, TLM_INFO, "Boss fight reset!")                                 \
+  X(BOSS_RESUMED, TLM_INFO, "Boss fight resumed! HP: %d")                      \
+  X(DROP_SPAWNED, TLM_INFO, "New drop appeared!")                              \
+  X(BOSS_HIT, TLM_INFO, "Boss hit! HP: %d")                                    \
+  X(PHASE2, TLM_INFO, "Phase 2 activated! Complex attack patterns incoming!")  \
+  X(BOSS_DEFEATED, TLM_INFO, "Boss defeated! You win!")                        \
+  X(ATTACK_START, TLM_INFO, "%a Zones:%z")                                     \
+  X(ATTACK_HIT, TLM_INFO, "%h")                                                \
+  X(ATTACK_END, TLM_INFO, "Attack ended!")                                     \
+  X(TELEMETRY_DROPPED, TLM_WARN, "[telemetry] %d records dropped")           \
+  X(SESSION_SEED, TLM_INFO, "[session] seed %l")                              \
+  X(INPUT_EDGE, TLM_INFO, "[session] pin %d down %d at %l us")              \
+  X(PERSIST_EMPTY, TLM_INFO, "[persist] nothing saved yet")                     \
+  X(PERSIST_LOADED, TLM_INFO, "[persist] slot %d of %d, sequence %u")          \
+  X(PERSIST_SAVED, TLM_DEBUG, "[persist] saved slot %d, sequence %u")         \
+  X(PROFILE_SUMMARY, TLM_INFO, "[profile] budget %u us, %l stalls")           \
+  X(PROFILE_SECTION, TLM_INFO, "[profile] %p: %l calls, min %u avg %u max %u us") \
+  X(PROFILE_HISTOGRAM, TLM_INFO,                                              \
+    "[profile] %p: <250us %u, <1ms %u, <4ms %u, <16ms %u, <64ms %u, more %u")  \
+  X(PROFILE_STALL, TLM_INFO, "[profile] stall: loop %u us, %p %u us, at %l ms")
+
+enum TelemetryLevel { TLM_DEBUG, TLM_INFO, TLM_WARN };
+
+#define TELEMETRY_EVENT_ID(name, level, format) EV_##name,
+enum TelemetryEvent { TELEMETRY_EVENTS(TELEMETRY_EVENT_ID) EV_COUNT };
+#undef TELEMETRY_EVENT_ID
+
+#endif
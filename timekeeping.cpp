@@ -0,0 +1,168 @@
+#include "settings.h"
+#include "timekeeping.h"
+
+// Ticks folded into the clock at a time: chunk * tickRate (at most
+// CLOCK_SPEED << 16, plus the trim) then stays within 32 bits together with
+// the remainder, and the milliseconds it adds within clockMillis
+#define TIME_CHUNK_MS (60000UL / CLOCK_SPEED)
+static_assert(CLOCK_SPEED >= 1 && CLOCK_SPEED <= 30000, "tickRate holds CLOCK_SPEED << 16 in 32 bits");
+static_assert(TIME_TRIM_LIMIT_PPM <= 50000L, "TIME_CHUNK_MS leaves room for 5% of trim");
+
+// Engine state
+static const TimeSource *timeSource = NULL;
+static uint32_t clockSeconds = 0;
+static uint16_t clockMillis = 0;
+static uint32_t clockFraction = 0;  // Sub-millisecond remainder, 16.16
+static uint32_t tickRate = (uint32_t)CLOCK_SPEED << 16; // Clock ms per tick ms, 16.16
+static long trimPpm = 0;
+static unsigned long lastTick = 0;
+static unsigned long lastSync = 0;
+
+// Drift estimate: true time against raw ticks since the last anchor
+static uint32_t anchorSeconds = 0;
+static uint32_t ticksSinceAnchor = 0;
+static bool anchored = false;
+
+static void applyTrim(long ppm) {
+  if (ppm > TIME_TRIM_LIMIT_PPM) ppm = TIME_TRIM_LIMIT_PPM;
+  if (ppm < -TIME_TRIM_LIMIT_PPM) ppm = -TIME_TRIM_LIMIT_PPM;
+  trimPpm = ppm;
+  int32_t nominal = (int32_t)CLOCK_SPEED << 16;
+  tickRate = nominal + (int32_t)((int64_t)nominal * ppm / 1000000L);
+}
+
+// Start keeping time, taking the initial time from the source if it has one
+void timeBegin(const TimeSource *source) {
+  timeSource = source;
+  lastTick = halMillis();
+  lastSync = lastTick;
+
+  uint32_t seconds;
+  if (timeSource && timeSource->begin() && timeSource->read(seconds)) {
+    clockSeconds = seconds;
+    anchorSeconds = seconds;
+    anchored = true;
+  } else {
+    timeSource = NULL; // No RTC fitted: free-run from millis()
+  }
+}
+
+// Compare with the RTC: re-estimate the drift and step out any error
+static void syncWithSource() {
+  uint32_t trueSeconds;
+  if (!timeSource->read(trueSeconds)) return;
+
+  if (!anchored) {
+    anchorSeconds = trueSeconds;
+    ticksSinceAnchor = 0;
+    anchored = true;
+  } else {
+    uint32_t spanSeconds = trueSeconds - anchorSeconds;
+    if (spanSeconds >= TIME_TRIM_BASELINE_S && ticksSinceAnchor > 0) {
+      // Raw ticks against true time gives the oscillator error directly;
+      // positive means millis() ran slow
+      int64_t errorMs = (int64_t)spanSeconds * 1000 - ticksSinceAnchor;
+      applyTrim((long)(errorMs * 1000000L / ticksSinceAnchor));
+      anchorSeconds = trueSeconds;
+      ticksSinceAnchor = 0;
+    }
+  }
+
+  if (trueSeconds != clockSeconds) {
+    clockSeconds = trueSeconds;
+    clockMillis = 0;
+    clockFraction = 0;
+  }
+}
+
+bool timeHasSource() {
+  return timeSource != NULL;
+}
+
+// Fold the ticks elapsed since the last call into the clock
+void timeUpdate() {
+  unsigned long now = halMillis();
+  unsigned long elapsed = now - lastTick; // Wrap-safe
+  lastTick = now;
+  ticksSinceAnchor += elapsed;
+
+  while (elapsed > 0) {
+    unsigned long chunk = elapsed > TIME_CHUNK_MS ? TIME_CHUNK_MS : elapsed;
+    elapsed -= chunk;
+    clockFraction += chunk * tickRate;
+    clockMillis += clockFraction >> 16;
+    clockFraction &= 0xFFFF;
+    while (clockMillis >= 1000) {
+      clockMillis -= 1000;
+      clockSeconds++;
+    }
+  }
+
+  // The RTC only describes real time, not the accelerated demo clock
+  if (timeSource && CLOCK_SPEED == 1 && now - lastSync >= TIME_SYNC_MS) {
+    lastSync = now;
+    syncWithSource();
+  }
+}
+
+// Set the time, and the RTC along with it
+void timeSet(uint32_t seconds) {
+  timeUpdate();
+  clockSeconds = seconds;
+  clockMillis = 0;
+  clockFraction = 0;
+  if (timeSource) {
+    timeSource->write(seconds);
+    anchorSeconds = seconds;
+    ticksSinceAnchor = 0;
+  }
+}
+
+uint32_t timeNow() {
+  return clockSeconds;
+}
+
+uint16_t timeMillisPart() {
+  return clockMillis;
+}
+
+long timeTrimPpm() {
+  return trimPpm;
+}
+
+// Days since 2000-01-01 (valid through 2099, where every 4th year is leap)
+static const uint16_t daysBeforeMonth[] PROGMEM = {
+  0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+};
+
+uint32_t secondsFromDate(int year, int month, int day, int hour, int minute, int second) {
+  int y = year - 2000;
+  uint32_t days = y * 365UL + (y + 3) / 4 + pgm_read_word(&daysBeforeMonth[month - 1]) + day - 1;
+  if (month > 2 && y % 4 == 0) days++;
+  return ((days * 24 + hour) * 60 + minute) * 60UL + second;
+}
+
+void dateFromSeconds(uint32_t seconds, int &year, int &month, int &day,
+                     int &hour, int &minute, int &second) {
+  second = seconds % 60;
+  minute = (seconds / 60) % 60;
+  hour = (seconds / 3600) % 24;
+  uint32_t days = seconds / 86400;
+
+  year = 2000;
+  while (true) {
+    uint16_t yearDays = (year % 4 == 0) ? 366 : 365;
+    if (days < yearDays) break;
+    days -= yearDays;
+    year++;
+  }
+  bool leap = year % 4 == 0;
+  for (month = 12; month > 1; month--) {
+    uint16_t before = pgm_read_word(&daysBeforeMonth[month - 1]) + ((leap && month > 2) ? 1 : 0);
+    if (days >= before) {
+      days -= before;
+      break;
+    }
+  }
+  day = days + 1;
+}
@@ -0,0 +1,43 @@
+#ifndef TIMEKEEPING_H
+#define TIMEKEEPING_H
+
+#include "hal.h"
+
+// Timekeeping engine
+//
+// Wall-clock time is whole seconds since 2000-01-01 plus a millisecond part,
+// advanced from the millis() tick in integer math. Elapsed ticks are always
+// taken as unsigned differences and folded in on every update, so the
+// millis() wrap after ~49 days is harmless. When a time source (RTC) is
+// present the engine syncs to it periodically and trims the tick rate to
+// cancel the drift of the board's oscillator.
+
+#define TIME_UPDATE_MS 100          // How often timeUpdate() runs
+#define TIME_SYNC_MS 60000UL        // How often the RTC is read
+#define TIME_TRIM_BASELINE_S 3600UL // Minimum span for a drift estimate
+#define TIME_TRIM_LIMIT_PPM 20000L
+
+// A source of true time, e.g. a battery-backed RTC
+struct TimeSource {
+  bool (*begin)();
+  bool (*read)(uint32_t &seconds);
+  bool (*write)(uint32_t seconds);
+};
+
+// RTC drivers
+extern const TimeSource ds3231TimeSource;
+
+void timeBegin(const TimeSource *source);
+void timeUpdate();
+void timeSet(uint32_t seconds);
+uint32_t timeNow();
+bool timeHasSource(); // An RTC was found at timeBegin()
+uint16_t timeMillisPart();
+long timeTrimPpm();
+
+// Calendar helpers for RTC drivers (years 2000-2099)
+uint32_t secondsFromDate(int year, int month, int day, int hour, int minute, int second);
+void dateFromSeconds(uint32_t seconds, int &year, int &month, int &day,
+                     int &hour, int &minute, int &second);
+
+#endif